@@ -0,0 +1,46 @@
+#include "aliastable.h"
+
+#include <numeric>
+
+void AliasTable::build(std::span<const double> weights)
+{
+    const auto n = weights.size();
+    const auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    m_probability.resize(n);
+    m_alias.resize(n);
+    m_small.clear();
+    m_large.clear();
+
+    for (uint32_t i = 0; i < n; ++i) {
+        m_probability[i] = total > 0.0 ? weights[i] * n / total : 1.0;
+        m_alias[i] = i;
+        (m_probability[i] < 1.0 ? m_small : m_large).push_back(i);
+    }
+
+    //! Every small column is topped up to 1 by exactly one large one.
+    while (!m_small.empty() && !m_large.empty()) {
+        const auto small = m_small.back();
+        const auto large = m_large.back();
+        m_small.pop_back();
+        m_large.pop_back();
+
+        m_alias[small] = large;
+        m_probability[large] += m_probability[small] - 1.0;
+        (m_probability[large] < 1.0 ? m_small : m_large).push_back(large);
+    }
+
+    //! What is left is 1 up to rounding.
+    for (const auto i : m_small) {
+        m_probability[i] = 1.0;
+    }
+
+    for (const auto i : m_large) {
+        m_probability[i] = 1.0;
+    }
+}
+
+size_t AliasTable::size() const
+{
+    return m_probability.size();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+#include "random.h"
+
+//! Walker's alias method with Vose's construction: O(n) to build from n weights,
+//! then every draw is one index and one coin, O(1) whatever the distribution.
+//! Rebuilding reuses the buffers.
+class AliasTable final
+{
+public:
+    //! Weights have to be finite and non-negative; all zero (or none) samples uniformly.
+    void build(std::span<const double> weights);
+
+    uint32_t sample(Random& random) const
+    {
+        const auto ix = static_cast<uint32_t>(random.index(m_probability.size()));
+        return random.uniform() < m_probability[ix] ? ix : m_alias[ix];
+    }
+
+    size_t size() const;
+
+private:
+    std::vector<double> m_probability;
+    std::vector<uint32_t> m_alias;
+    std::vector<uint32_t> m_small;
+    std::vector<uint32_t> m_large;
+};
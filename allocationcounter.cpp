@@ -0,0 +1,36 @@
+#include "allocationcounter.h"
+
+#include <atomic>
+
+namespace
+{
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<bool> installed{false};
+}
+
+bool AllocationCounter::enabled()
+{
+    return installed.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::allocations()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::bytes()
+{
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+void AllocationCounter::install()
+{
+    installed.store(true, std::memory_order_relaxed);
+}
+
+void AllocationCounter::record(const size_t bytes)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//! Process-wide heap allocation counter. It only counts in executables linked with the
+//! replacement global operator new of allocationhooks.cpp (GENETIC_ALGO_COUNT_ALLOCATIONS,
+//! the benchmark only), otherwise enabled() is false and the counters stay at zero.
+class AllocationCounter final
+{
+public:
+    static bool enabled();
+    static uint64_t allocations();
+    static uint64_t bytes();
+
+    //! Called by allocationhooks.cpp: once at startup, then per allocation.
+    static void install();
+    static void record(const size_t bytes);
+};
@@ -0,0 +1,75 @@
+#include "allocationcounter.h"
+
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+
+//! Replacement of the global operator new and delete that feeds AllocationCounter.
+//! Linked into the executables that read the counts only (the benchmark), never into
+//! the library, so its users keep their own allocator.
+
+namespace
+{
+const bool installed = (AllocationCounter::install(), true);
+
+void* allocate(const size_t size, const size_t alignment)
+{
+    AllocationCounter::record(size);
+
+    const auto bytes = size == 0 ? 1 : size;
+
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(bytes);
+    }
+
+#ifdef _WIN32
+    return _aligned_malloc(bytes, alignment);
+#else
+    return std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void* allocateOrThrow(const size_t size, const size_t alignment)
+{
+    if (auto* ptr = allocate(size, alignment)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void release(void* ptr, const size_t alignment)
+{
+#ifdef _WIN32
+    if (alignment > alignof(std::max_align_t)) {
+        return _aligned_free(ptr);
+    }
+#else
+    (void)alignment;
+#endif
+
+    std::free(ptr);
+}
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return allocateOrThrow(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t al) { return allocateOrThrow(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return allocateOrThrow(size, static_cast<size_t>(al)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return allocate(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return allocate(size, static_cast<size_t>(al)); }
+
+void operator delete(void* ptr) noexcept { release(ptr, alignof(std::max_align_t)); }
+void operator delete[](void* ptr) noexcept { release(ptr, alignof(std::max_align_t)); }
+void operator delete(void* ptr, size_t) noexcept { release(ptr, alignof(std::max_align_t)); }
+void operator delete[](void* ptr, size_t) noexcept { release(ptr, alignof(std::max_align_t)); }
+void operator delete(void* ptr, std::align_val_t al) noexcept { release(ptr, static_cast<size_t>(al)); }
+void operator delete[](void* ptr, std::align_val_t al) noexcept { release(ptr, static_cast<size_t>(al)); }
+void operator delete(void* ptr, size_t, std::align_val_t al) noexcept { release(ptr, static_cast<size_t>(al)); }
+void operator delete[](void* ptr, size_t, std::align_val_t al) noexcept { release(ptr, static_cast<size_t>(al)); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr, alignof(std::max_align_t)); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr, alignof(std::max_align_t)); }
+void operator delete(void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept { release(ptr, static_cast<size_t>(al)); }
+void operator delete[](void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept { release(ptr, static_cast<size_t>(al)); }
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <type_traits>
+#include <string>
+#include <utility>
+
+#include "individual.h"
+#include "geneticoperators.h"
+
+//! Encodings of the compile time individual family.
+//! Width is the number of Values a Dim gene row is stored in.
+struct RealEncoding
+{
+    using Value = double;
+    static constexpr Individual::Type type = Individual::Type::Discrete;
+
+    template<size_t Dim>
+    static constexpr size_t Width = Dim;
+};
+
+//! Gray codes of \a Bits bits per gene, packed into 64-bit words.
+template<unsigned Bits = 8>
+struct GrayEncoding
+{
+    static_assert(Bits >= 1 && Bits <= 64, "a gene has to fit into one word");
+
+    using Value = GeneticOperators::Code;
+    static constexpr Individual::Type type = Individual::Type::GrayCode;
+    static constexpr unsigned bitsPerGene = Bits;
+
+    template<size_t Dim>
+    static constexpr size_t Width = GeneticOperators::wordsFor(Dim, Bits);
+};
+
+//! Individual with its encoding and gene count fixed at compile time, backed by a
+//! std::array: no variant checks, no heap, and constant trip counts in every loop.
+//! Individual remains the runtime-dimension counterpart.
+template<class Encoding, size_t Dim>
+class BasicIndividual final
+{
+public:
+    using Bounds = std::pair<double, double>;
+    using Value = typename Encoding::Value;
+    using Genes = std::array<Value, Encoding::template Width<Dim>>;
+
+    static constexpr size_t dimentions = Dim;
+    static constexpr bool IsReal = std::is_same_v<Encoding, RealEncoding>;
+
+    BasicIndividual() = default;
+    BasicIndividual(const Genes& genes, const double fitness = 0.0)
+        : m_fitness{fitness}
+        , m_genes{genes}
+    {}
+
+    Genes& genes() { return m_genes; }
+    const Genes& genes() const { return m_genes; }
+
+    void setFitness(const double val) { m_fitness = val; }
+    double fitness() const { return m_fitness; }
+
+    void mutate(Random& random, const double probability, const Bounds& bounds = std::pair(-1.0, 1.0))
+        requires IsReal
+    {
+        GeneticOperators::mutate(std::span<double, Dim>(m_genes), random, probability, bounds);
+    }
+
+    //! Real valued genes, Gray codes are mapped onto \a bounds.
+    std::array<double, Dim> decode(const Bounds& bounds) const
+    {
+        if constexpr (IsReal) {
+            return m_genes;
+        } else {
+            std::array<double, Dim> decoded;
+            GeneticOperators::decode(std::span<const Value, Encoding::template Width<Dim>>(m_genes), Encoding::bitsPerGene,
+                                     std::span<double, Dim>(decoded), bounds);
+            return decoded;
+        }
+    }
+
+    Individual toIndividual() const
+    {
+        Individual ind(Dim, Encoding::type, codeBits());
+
+        if constexpr (IsReal) {
+            for (const auto gene : m_genes) {
+                ind.append(gene);
+            }
+        } else {
+            for (size_t gene = 0; gene < Dim; ++gene) {
+                ind.appendCode(GeneticOperators::extract(std::span<const Value>(m_genes), gene, Encoding::bitsPerGene));
+            }
+        }
+
+        ind.setFitness(m_fitness);
+
+        return ind;
+    }
+
+    std::string toString() const
+    {
+        return toIndividual().toString();
+    }
+
+private:
+    static constexpr uint8_t codeBits()
+    {
+        if constexpr (IsReal) {
+            return 8;
+        } else {
+            return Encoding::bitsPerGene;
+        }
+    }
+
+    double m_fitness = 0.0;
+    Genes m_genes{};
+};
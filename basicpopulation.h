@@ -0,0 +1,336 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <sstream>
+#include <algorithm>
+#include <type_traits>
+
+#include "population.h"
+#include "basicindividual.h"
+#include "individualfactory.h"
+
+//! Gene matrix of BasicIndividual rows: the rows are std::arrays laid out back to back,
+//! so it is one contiguous size x Dim matrix plus a fitness array, like GenePool.
+template<class Encoding, size_t Dim>
+class BasicGenePool final
+{
+public:
+    using Value = typename Encoding::Value;
+    using Row = typename BasicIndividual<Encoding, Dim>::Genes;
+    using Code = GeneticOperators::Code;
+
+    static constexpr size_t Width = Encoding::template Width<Dim>;
+    static_assert(sizeof(Row) == sizeof(Value) * Width, "rows have to be tightly packed");
+    static constexpr bool IsReal = std::is_same_v<Encoding, RealEncoding>;
+
+    explicit BasicGenePool(const size_t size = 0)
+        : m_genes(size)
+        , m_fitness(size)
+        , m_dirty(size, 1)
+    {}
+
+    std::span<double, Dim> genes(const size_t ix) requires IsReal { return m_genes[ix]; }
+    std::span<const double, Dim> genes(const size_t ix) const requires IsReal { return m_genes[ix]; }
+
+    std::span<Code, Width> codes(const size_t ix) requires (!IsReal) { return m_genes[ix]; }
+    std::span<const Code, Width> codes(const size_t ix) const requires (!IsReal) { return m_genes[ix]; }
+
+    void setFitness(const size_t ix, const double val) { m_fitness[ix] = val; }
+    double fitness(const size_t ix) const { return m_fitness[ix]; }
+    std::span<const double> fitnesses() const { return m_fitness; }
+    std::span<double> fitnesses(const size_t begin, const size_t end)
+    {
+        return std::span<double>(m_fitness).subspan(begin, end - begin);
+    }
+
+    bool dirty(const size_t ix) const { return m_dirty[ix]; }
+    void setDirty(const size_t ix, const bool dirty) { m_dirty[ix] = dirty; }
+    void setAllDirty() { std::ranges::fill(m_dirty, 1); }
+
+    std::span<const std::byte> rowBytes(const size_t ix) const { return std::as_bytes(std::span<const Value, Width>(m_genes[ix])); }
+    bool sameRow(const size_t ix, const BasicGenePool& other, const size_t otherIx) const
+    {
+        return std::ranges::equal(rowBytes(ix), other.rowBytes(otherIx));
+    }
+
+    //! Real gene rows [begin, end).
+    GeneTile tile(const size_t begin, const size_t end) const requires IsReal
+    {
+        const auto* first = reinterpret_cast<const double*>(m_genes.data() + begin);
+        return GeneTile{std::span<const double>(first, (end - begin) * Dim), end - begin, Dim};
+    }
+
+    void copyRow(const size_t ix, const BasicGenePool& from, const size_t fromIx)
+    {
+        m_genes[ix] = from.m_genes[fromIx];
+        m_fitness[ix] = from.m_fitness[fromIx];
+        m_dirty[ix] = from.m_dirty[fromIx];
+    }
+
+    //! Empty pool of the same shape with \a size rows.
+    BasicGenePool withSize(const size_t size) const
+    {
+        return BasicGenePool(size);
+    }
+
+    BasicIndividual<Encoding, Dim> individual(const size_t ix) const
+    {
+        return BasicIndividual<Encoding, Dim>(m_genes[ix], m_fitness[ix]);
+    }
+
+    void setIndividual(const size_t ix, const BasicIndividual<Encoding, Dim>& ind)
+    {
+        m_genes[ix] = ind.genes();
+        m_fitness[ix] = ind.fitness();
+        m_dirty[ix] = 1;
+    }
+
+    size_t size() const { return m_genes.size(); }
+    static constexpr size_t dimentions() { return Dim; }
+    static constexpr Individual::Type type() { return Encoding::type; }
+    static constexpr uint8_t bitsPerGene() requires (!IsReal) { return Encoding::bitsPerGene; }
+
+    std::string toString(const size_t ix) const
+    {
+        return individual(ix).toString();
+    }
+
+private:
+    std::vector<Row> m_genes;
+    std::vector<double> m_fitness;
+    std::vector<uint8_t> m_dirty;
+};
+
+//! Population of BasicIndividual<Encoding, Dim>, with the same interface as Population so
+//! GeneticAlgo drives both the same way. The encoding picks the crossovers at compile
+//! time: Discrete and Linear for RealEncoding, TwoPoint for GrayEncoding.
+template<class Encoding, size_t Dim>
+class BasicPopulation final
+{
+public:
+    using Bounds = std::pair<double, double>;
+    using Individuals = BasicGenePool<Encoding, Dim>;
+    using Parents = Selection::Parents;
+    using SelectionType = Population::SelectionType;
+    using CrossoverType = Population::CrossoverType;
+    using ReplacementType = Population::ReplacementType;
+    using SamplingType = Population::SamplingType;
+    using MutationType = Population::MutationType;
+
+    BasicPopulation(const uint32_t size = 10, const Bounds& bounds = std::make_pair(-1.0, 1.0), const Random& random = Random{})
+        : m_individuals(size)
+        , m_offspring(size)
+        , m_bounds{bounds}
+        , m_random{random}
+    {
+        for (size_t i = 0; i < m_individuals.size(); ++i) {
+            if constexpr (Individuals::IsReal) {
+                IndividualFactory::create(std::span<double>(m_individuals.genes(i)), bounds, m_random);
+            } else {
+                IndividualFactory::create(std::span<GenePool::Code>(m_individuals.codes(i)), Dim,
+                                          Encoding::bitsPerGene, bounds, m_random);
+            }
+        }
+    }
+
+    //! Selections
+    bool selection(const SelectionType selectionType, Parents& parents, const SamplingType sampling = SamplingType::Roulette)
+    {
+        return Selection::select(selectionType, m_individuals.fitnesses(), m_random, parents, m_selection, sampling);
+    }
+
+    //! Single parent draws, same contract as Population::prepareSelection.
+    bool prepareSelection(const SelectionType selectionType, const SamplingType sampling = SamplingType::Roulette)
+    {
+        return Selection::prepare(selectionType, m_individuals.fitnesses(), m_random, m_selection, sampling);
+    }
+
+    uint32_t drawParent()
+    {
+        return Selection::draw(m_individuals.fitnesses(), m_random, m_selection);
+    }
+
+    template<class Func>
+    void updateFitness(Func f)
+    {
+        m_evaluator.update(m_individuals, f, m_bounds);
+    }
+
+    template<class Func>
+    void updateFitness(const Func& f, ThreadPool& pool)
+    {
+        m_evaluator.update(m_individuals, f, m_bounds, pool);
+    }
+
+    template<class Func>
+    void updateFitness(Individuals& individuals, const size_t ix, const Func& f)
+    {
+        m_evaluator.updateRow(individuals, ix, f, m_bounds);
+    }
+
+    void invalidateFitness() { m_individuals.setAllDirty(); }
+    void setFitnessCache(const size_t capacity) { m_evaluator.setCacheCapacity(capacity); }
+    void setSurrogate(const double fraction, const size_t neighbours, const size_t archive = KdTree::DefaultCapacity)
+    {
+        m_evaluator.setSurrogate(fraction, neighbours, archive);
+    }
+    const FitnessEvaluator& evaluator() const { return m_evaluator; }
+
+    //! Crossovers, same contract as Population::crossover.
+    bool crossover(const CrossoverType type, const size_t parent1, const size_t parent2,
+                   Individuals& children, const size_t child)
+    {
+        const auto& parents = std::as_const(m_individuals);
+        const bool hasSecond = child + 1 < children.size();
+
+        if constexpr (Individuals::IsReal) {
+            const auto second = hasSecond ? std::span<double>(children.genes(child + 1)) : std::span<double>{};
+
+            switch (type) {
+            case CrossoverType::Discrete:
+                GeneticOperators::discreteCrossover(parents.genes(parent1), parents.genes(parent2),
+                                                    children.genes(child), second, m_random);
+                break;
+            case CrossoverType::Linear:
+                GeneticOperators::linearCrossover(parents.genes(parent1), parents.genes(parent2),
+                                                  children.genes(child), second);
+                break;
+            default:
+                return false;
+            }
+        } else {
+            const auto second = hasSecond ? std::span<Code>(children.codes(child + 1)) : std::span<Code>{};
+
+            if (type != CrossoverType::TwoPoint) {
+                return false;
+            }
+
+            GeneticOperators::twoPointCrossover(parents.codes(parent1), parents.codes(parent2),
+                                                children.codes(child), second, Dim * Individuals::bitsPerGene(), m_random);
+        }
+
+        GeneticOperators::inherit(m_individuals, children, child, parent1, parent2);
+
+        if (hasSecond) {
+            GeneticOperators::inherit(m_individuals, children, child + 1, parent1, parent2);
+        }
+
+        return true;
+    }
+
+    void mutate(Individuals& individuals, const size_t ix, const double probability)
+    {
+        bool mutated = false;
+
+        if constexpr (Individuals::IsReal) {
+            mutated = GeneticOperators::mutate(individuals.genes(ix), m_random, probability, m_bounds);
+        } else {
+            mutated = GeneticOperators::flipMutate(individuals.codes(ix), m_random, probability, Dim * Individuals::bitsPerGene());
+        }
+
+        if (mutated) {
+            individuals.setDirty(ix, true);
+        }
+    }
+
+    bool mutate(Individuals& individuals, const MutationType type, const double rate, const size_t begin = 0,
+                size_t end = SIZE_MAX)
+    {
+        end = std::min(end, individuals.size());
+        const auto rows = end > begin ? end - begin : 0;
+
+        if constexpr (Individuals::IsReal) {
+            return GeneticOperators::sparseMutate(
+                type, rows, Dim, rate, m_bounds, m_random,
+                [&](const size_t row, const size_t at) { return individuals.genes(begin + row)[at]; },
+                [&](const size_t row, const size_t at, const double value) {
+                    individuals.genes(begin + row)[at] = value;
+                    individuals.setDirty(begin + row, true);
+                });
+        } else {
+            if (type != MutationType::BitFlip) {
+                return false;
+            }
+
+            GeneticOperators::sparseFlip(
+                rows, Dim * Individuals::bitsPerGene(), rate, m_random,
+                [&](const size_t row) { return individuals.codes(begin + row); },
+                [&](const size_t row) { individuals.setDirty(begin + row, true); });
+
+            return true;
+        }
+    }
+
+    size_t best() const { return Selection::best(m_individuals); }
+
+    bool replace(const ReplacementType type, const Individuals& from, const size_t fromIx)
+    {
+        const auto victim = Selection::victim(m_individuals.fitnesses(), type, from.fitness(fromIx), m_random);
+
+        if (!victim) {
+            return false;
+        }
+
+        m_individuals.copyRow(*victim, from, fromIx);
+        return true;
+    }
+
+    void emigrate(Individuals& migrants) { Selection::emigrate(m_individuals, migrants, m_order); }
+    void immigrate(const Individuals& migrants) { Selection::immigrate(m_individuals, migrants, m_order); }
+
+    //! Same as Population::adopt and countEvaluations.
+    void adopt(const size_t ix, const Individuals& from, const size_t fromIx)
+    {
+        m_individuals.copyRow(ix, from, fromIx);
+    }
+
+    void countEvaluations(const uint64_t count) { m_evaluator.addEvaluations(count); }
+
+    Individuals& offspring() { return m_offspring; }
+    void swapGenerations() { std::swap(m_individuals, m_offspring); }
+
+    Random& random() { return m_random; }
+
+    size_t size() const { return m_individuals.size(); }
+    void setIndividuals(Individuals&& inds)
+    {
+        if (inds.size() != m_offspring.size()) {
+            m_offspring = inds.withSize(inds.size());
+        }
+
+        m_individuals = std::move(inds);
+    }
+    const Individuals& individuals() const { return m_individuals; }
+    const Bounds& bounds() const { return m_bounds; }
+
+    std::string toString() const
+    {
+        std::stringstream oss;
+        oss << "Size: " << m_individuals.size() << " ";
+        oss << "[";
+
+        for (size_t i = 0; i < m_individuals.size(); ++i) {
+            oss << m_individuals.toString(i);
+            if (i < m_individuals.size() - 1) {
+                oss << ", ";
+            }
+        }
+        oss << "]";
+
+        return oss.str();
+    }
+
+private:
+    using Code = GeneticOperators::Code;
+
+    Individuals m_individuals;
+    Individuals m_offspring;
+    Selection::Scratch m_selection;
+    Parents m_order;
+    FitnessEvaluator m_evaluator;
+    Bounds m_bounds;
+    Random m_random;
+};
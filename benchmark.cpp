@@ -0,0 +1,341 @@
+#include <chrono>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include "pareto.h"
+#include "geneticalgo.h"
+#include "individualfactory.h"
+#include "benchmarkfunctions.h"
+#include "allocationcounter.h"
+
+//! Micro-benchmarks of every operator over a grid of population shapes.
+//! Usage: genetic_algo_benchmark [results.json]
+//! A table goes to stdout, the same numbers as JSON to the file (benchmark.json by
+//! default), one record per (operator, size, dimentions, encoding) so two runs can be
+//! diffed or joined on those keys.
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr double MinBatchNs = 20e6;
+constexpr int Repeats = 3;
+constexpr uint8_t GrayBits = 16;
+//! Epochs the epoch benchmark adds on top of a one epoch run.
+constexpr uint8_t ExtraEpochs = 20;
+
+struct Shape
+{
+    uint32_t size;
+    size_t dimentions;
+    Population::IndividualType type;
+};
+
+struct Result
+{
+    std::string name;
+    Shape shape;
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    double allocationsPerOp = 0.0;
+    double individualsPerSecond = 0.0;
+};
+
+std::string encoding(const Shape& shape)
+{
+    return shape.type == Population::IndividualType::GrayCode ? "gray" + std::to_string(GrayBits) : "real";
+}
+
+//! Doubles the batch until it runs for MinBatchNs, then keeps the fastest of Repeats batches.
+//! Every op processes \a individuals individuals.
+template<class Op>
+Result measure(const std::string& name, const Shape& shape, const size_t individuals, Op&& op)
+{
+    const auto batch = [&op](const uint64_t iterations) {
+        const auto start = Clock::now();
+
+        for (uint64_t i = 0; i < iterations; ++i) {
+            op();
+        }
+
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    //! Warm up: first touch of scratch buffers, caches, branch predictors.
+    op();
+
+    uint64_t iterations = 1;
+
+    while (batch(iterations) < MinBatchNs) {
+        iterations *= 2;
+    }
+
+    Result result{name, shape, iterations, std::numeric_limits<double>::max()};
+
+    for (int r = 0; r < Repeats; ++r) {
+        const auto allocations = AllocationCounter::allocations();
+        const auto ns = batch(iterations);
+
+        result.nsPerOp = std::min(result.nsPerOp, ns / iterations);
+        result.allocationsPerOp = double(AllocationCounter::allocations() - allocations) / iterations;
+    }
+
+    result.individualsPerSecond = individuals * 1e9 / result.nsPerOp;
+
+    return result;
+}
+
+GeneticAlgo::PopulationSettings settings(const Shape& shape)
+{
+    GeneticAlgo::PopulationSettings settings;
+    settings.size = shape.size;
+    settings.dimentions = shape.dimentions;
+    settings.type = shape.type;
+    settings.bounds = std::make_pair(-5.12, 5.12);
+    settings.selection = Population::SelectionType::Tournament;
+    settings.crossover = shape.type == Population::IndividualType::GrayCode ? Population::CrossoverType::TwoPoint
+                                                                            : Population::CrossoverType::Discrete;
+    settings.mutationChance = 0.05;
+    settings.bitsPerGene = GrayBits;
+
+    return settings;
+}
+
+void benchmarkShape(const Shape& shape, ThreadPool& threads, std::vector<Result>& results)
+{
+    using SelectionType = Population::SelectionType;
+    using CrossoverType = Population::CrossoverType;
+
+    const auto bounds = std::make_pair(-5.12, 5.12);
+    const Rastrigin rastrigin;
+
+    Population population(shape.size, shape.dimentions, shape.type, bounds, GrayBits, Random(1));
+    population.updateFitness(rastrigin);
+
+    Population::Parents parents;
+
+    using SamplingType = Population::SamplingType;
+
+    const std::tuple<const char*, SelectionType, SamplingType> selections[] = {
+        {"selection.tournament", SelectionType::Tournament, SamplingType::Roulette},
+        {"selection.rank", SelectionType::Rank, SamplingType::Roulette},
+        {"selection.rank.sus", SelectionType::Rank, SamplingType::Universal},
+        {"selection.exponential_rank", SelectionType::ExponentialRank, SamplingType::Roulette},
+        {"selection.panmixia", SelectionType::Panmixia, SamplingType::Roulette},
+        {"selection.proportional", SelectionType::Proportional, SamplingType::Roulette},
+        {"selection.proportional.sus", SelectionType::Proportional, SamplingType::Universal},
+    };
+
+    for (const auto& [name, type, sampling] : selections) {
+        results.push_back(measure(name, shape, shape.size, [&]() {
+            population.selection(type, parents, sampling);
+        }));
+    }
+
+    population.selection(SelectionType::Tournament, parents);
+    auto& offspring = population.offspring();
+
+    std::vector<std::pair<const char*, CrossoverType>> crossovers;
+
+    if (shape.type == Population::IndividualType::GrayCode) {
+        crossovers = {{"crossover.two_point", CrossoverType::TwoPoint}};
+    } else {
+        crossovers = {{"crossover.discrete", CrossoverType::Discrete}, {"crossover.linear", CrossoverType::Linear}};
+    }
+
+    for (const auto& [name, type] : crossovers) {
+        results.push_back(measure(name, shape, shape.size, [&]() {
+            for (size_t i = 0; i < parents.size(); i += 2) {
+                population.crossover(type, parents[i], parents[(i + 1) % parents.size()], offspring, i);
+            }
+        }));
+    }
+
+    results.push_back(measure("mutate", shape, shape.size, [&]() {
+        for (size_t i = 0; i < offspring.size(); ++i) {
+            population.mutate(offspring, i, 1.0);
+        }
+    }));
+
+    //! About one mutation per individual.
+    if (shape.type == Population::IndividualType::GrayCode) {
+        results.push_back(measure("mutate.sparse.bit_flip", shape, shape.size, [&]() {
+            population.mutate(offspring, Population::MutationType::BitFlip, 1.0 / (shape.dimentions * GrayBits));
+        }));
+    } else {
+        results.push_back(measure("mutate.sparse.gaussian", shape, shape.size, [&]() {
+            population.mutate(offspring, Population::MutationType::Gaussian, 1.0 / shape.dimentions);
+        }));
+        results.push_back(measure("mutate.sparse.polynomial", shape, shape.size, [&]() {
+            population.mutate(offspring, Population::MutationType::Polynomial, 1.0 / shape.dimentions);
+        }));
+    }
+
+    if (shape.type == Population::IndividualType::Discrete) {
+        Random random(2);
+        auto individual = IndividualFactory::create(shape.type, shape.dimentions, bounds, random);
+
+        results.push_back(measure("individual.mutate", shape, 1, [&]() {
+            individual.mutate(random, 1.0, bounds);
+        }));
+    }
+
+    results.push_back(measure("update_fitness", shape, shape.size, [&]() {
+        population.invalidateFitness();
+        population.updateFitness(rastrigin);
+    }));
+
+    results.push_back(measure("update_fitness.parallel", shape, shape.size, [&]() {
+        population.invalidateFitness();
+        population.updateFitness(rastrigin, threads);
+    }));
+
+    const auto chunked = [&rastrigin](const GeneBlock& block, const double partial) { return rastrigin(block, partial); };
+
+    results.push_back(measure("update_fitness.chunked", shape, shape.size, [&]() {
+        population.invalidateFitness();
+        population.updateFitness(chunked);
+    }));
+
+    //! GeneticAlgo::run builds its population first, so an epoch is the difference
+    //! between a run of 1 + ExtraEpochs epochs and a run of one.
+    const auto target = std::numeric_limits<double>::lowest();
+
+    GeneticAlgo single(1);
+    GeneticAlgo longer(1 + ExtraEpochs);
+
+    const auto measureEpoch = [&](const std::string& name, const GeneticAlgo::PopulationSettings& runSettings) {
+        const auto base = measure(name + ".run.1", shape, shape.size, [&]() {
+            single.run(runSettings, rastrigin, target);
+        });
+        const auto extended = measure(name + ".run.n", shape, shape.size, [&]() {
+            longer.run(runSettings, rastrigin, target);
+        });
+
+        Result epoch{name, shape, extended.iterations};
+        epoch.nsPerOp = std::max(0.0, (extended.nsPerOp - base.nsPerOp) / ExtraEpochs);
+        epoch.allocationsPerOp = std::max(0.0, (extended.allocationsPerOp - base.allocationsPerOp) / ExtraEpochs);
+        epoch.individualsPerSecond = epoch.nsPerOp > 0.0 ? shape.size * 1e9 / epoch.nsPerOp : 0.0;
+
+        results.push_back(epoch);
+    };
+
+    auto runSettings = settings(shape);
+    measureEpoch("epoch", runSettings);
+
+    runSettings.fused = true;
+    measureEpoch("epoch.fused", runSettings);
+
+    if (shape.type == Population::IndividualType::Discrete) {
+        runSettings.fused = false;
+        runSettings.precision = Population::GenePrecision::Float;
+        measureEpoch("epoch.float", runSettings);
+
+        runSettings.precision = Population::GenePrecision::Fixed16;
+        measureEpoch("epoch.fixed16", runSettings);
+    }
+}
+
+//! Pareto ranking of \a size random objective rows, the shape's dimentions being
+//! the number of objectives.
+void benchmarkPareto(const Shape& shape, std::vector<Result>& results)
+{
+    Random random(1);
+    std::vector<double> values(shape.size * shape.dimentions);
+    std::ranges::generate(values, [&]() { return random.uniform(); });
+
+    std::vector<uint32_t> fronts, survivors;
+    std::vector<double> crowding;
+    Pareto::Scratch scratch;
+
+    results.push_back(measure("pareto.sort", shape, shape.size, [&]() {
+        Pareto::sort(values, shape.dimentions, fronts, scratch);
+    }));
+    results.push_back(measure("pareto.select", shape, shape.size, [&]() {
+        Pareto::select(values, shape.dimentions, shape.size / 2, survivors, fronts, crowding, scratch);
+    }));
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results, const size_t threads)
+{
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"allocation_counting\": " << (AllocationCounter::enabled() ? "true" : "false") << ",\n";
+    out << "  \"threads\": " << threads << ",\n";
+    out << "  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+
+        out << "    {\"name\": \"" << r.name << "\", \"size\": " << r.shape.size
+            << ", \"dimentions\": " << r.shape.dimentions << ", \"encoding\": \"" << encoding(r.shape)
+            << "\", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.nsPerOp
+            << ", \"allocations_per_op\": " << r.allocationsPerOp
+            << ", \"individuals_per_second\": " << r.individualsPerSecond << "}";
+        out << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+void writeTable(std::ostream& out, const std::vector<Result>& results)
+{
+    out << std::left << std::setw(26) << "benchmark" << std::setw(8) << "size" << std::setw(8) << "dims"
+        << std::setw(9) << "encoding" << std::right << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op"
+        << std::setw(16) << "individuals/s" << "\n";
+
+    for (const auto& r : results) {
+        out << std::left << std::setw(26) << r.name << std::setw(8) << r.shape.size << std::setw(8)
+            << r.shape.dimentions << std::setw(9) << encoding(r.shape) << std::right << std::fixed
+            << std::setprecision(1) << std::setw(14) << r.nsPerOp << std::setprecision(2) << std::setw(12)
+            << r.allocationsPerOp << std::setprecision(0) << std::setw(16) << r.individualsPerSecond << "\n";
+    }
+}
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string path = argc > 1 ? argv[1] : "benchmark.json";
+
+    ThreadPool threads;
+    std::vector<Result> results;
+
+    for (const uint32_t size : {64u, 1024u, 8192u}) {
+        for (const size_t dimentions : {size_t{8}, size_t{64}}) {
+            for (const auto type : {Population::IndividualType::Discrete, Population::IndividualType::GrayCode}) {
+                benchmarkShape(Shape{size, dimentions, type}, threads, results);
+            }
+        }
+    }
+
+    //! Long genomes: the blocked kernels.
+    for (const auto type : {Population::IndividualType::Discrete, Population::IndividualType::GrayCode}) {
+        benchmarkShape(Shape{64, size_t{1} << 16, type}, threads, results);
+    }
+
+    for (const uint32_t size : {1024u, 131072u}) {
+        for (const size_t objectives : {size_t{2}, size_t{3}}) {
+            benchmarkPareto(Shape{size, objectives, Population::IndividualType::Discrete}, results);
+        }
+    }
+
+    writeTable(std::cout, results);
+
+    std::ofstream file(path);
+    writeJson(file, results, threads.size());
+
+    if (!file) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return 1;
+    }
+
+    std::cout << "results written to " << path << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "benchmarkfunctions.h"
+
+#include <cmath>
+#include <cassert>
+#include <numbers>
+
+#include "simdkernels.h"
+
+namespace
+{
+//! Hands the kernel class matching \a level to \a vectorized, or runs the scalar
+//! function row by row when no SIMD level is available.
+template<class Scalar, class Vectorized>
+void dispatch(const CpuFeatures::SimdLevel level, const GeneTile& tile, std::span<double> fitness,
+              const Scalar& scalar, Vectorized vectorized)
+{
+    assert(fitness.size() == tile.rows);
+
+    switch (CpuFeatures::get().resolve(level)) {
+#ifdef GENETIC_ALGO_AVX512
+    case CpuFeatures::SimdLevel::Avx512:
+        return vectorized(Avx512Kernels{});
+#endif
+#ifdef GENETIC_ALGO_AVX2
+    case CpuFeatures::SimdLevel::Avx2:
+        return vectorized(Avx2Kernels{});
+#endif
+    default:
+        for (size_t i = 0; i < tile.rows; ++i) {
+            fitness[i] = scalar(tile.row(i));
+        }
+    }
+}
+}
+
+double Sphere::operator()(std::span<const double> x) const
+{
+    double result = 0.0;
+
+    for (const auto value : x) {
+        result += value * value;
+    }
+
+    return result;
+}
+
+void Sphere::operator()(const GeneTile& tile, std::span<double> fitness) const
+{
+    dispatch(level, tile, fitness, *this, [&](auto kernels) {
+        kernels.sphere(tile.genes.data(), tile.rows, tile.dimentions, fitness.data());
+    });
+}
+
+double Sphere::operator()(const GeneBlock& block, const double partial) const
+{
+    return partial + (*this)(block.genes);
+}
+
+double Rastrigin::operator()(std::span<const double> x) const
+{
+    double result = 10.0 * x.size();
+
+    for (const auto value : x) {
+        result += value * value - 10.0 * std::cos(2 * std::numbers::pi * value);
+    }
+
+    return result;
+}
+
+void Rastrigin::operator()(const GeneTile& tile, std::span<double> fitness) const
+{
+    dispatch(level, tile, fitness, *this, [&](auto kernels) {
+        kernels.rastrigin(tile.genes.data(), tile.rows, tile.dimentions, fitness.data());
+    });
+}
+
+double Rastrigin::operator()(const GeneBlock& block, const double partial) const
+{
+    return partial + (*this)(block.genes);
+}
+
+double Rosenbrock::operator()(std::span<const double> x) const
+{
+    double result = 0.0;
+
+    for (size_t i = 0; i + 1 < x.size(); ++i) {
+        const auto a = x[i + 1] - x[i] * x[i];
+        const auto b = 1.0 - x[i];
+        result += 100.0 * a * a + b * b;
+    }
+
+    return result;
+}
+
+void Rosenbrock::operator()(const GeneTile& tile, std::span<double> fitness) const
+{
+    dispatch(level, tile, fitness, *this, [&](auto kernels) {
+        kernels.rosenbrock(tile.genes.data(), tile.rows, tile.dimentions, fitness.data());
+    });
+}
+
+double Ackley::operator()(std::span<const double> x) const
+{
+    double squares = 0.0;
+    double cosines = 0.0;
+
+    for (const auto value : x) {
+        squares += value * value;
+        cosines += std::cos(2 * std::numbers::pi * value);
+    }
+
+    const auto n = static_cast<double>(x.size());
+
+    return -20.0 * std::exp(-0.2 * std::sqrt(squares / n)) - std::exp(cosines / n) + 20.0 + std::numbers::e;
+}
+
+void Ackley::operator()(const GeneTile& tile, std::span<double> fitness) const
+{
+    dispatch(level, tile, fitness, *this, [&](auto kernels) {
+        kernels.ackley(tile.genes.data(), tile.rows, tile.dimentions, fitness.data());
+    });
+}
+
+double Michalewicz::operator()(std::span<const double> x) const
+{
+    double result = 0.0;
+
+    for (size_t i = 0; i < x.size(); ++i) {
+        const auto sinArg = ((i + 1) / std::numbers::pi) * x[i] * x[i];
+        result += std::sin(x[i]) * std::pow(std::sin(sinArg), 2 * m);
+    }
+
+    return -result;
+}
+
+void Michalewicz::operator()(const GeneTile& tile, std::span<double> fitness) const
+{
+    dispatch(level, tile, fitness, *this, [&](auto kernels) {
+        kernels.michalewicz(tile.genes.data(), tile.rows, tile.dimentions, fitness.data(), m);
+    });
+}
+
+double Michalewicz::operator()(const GeneBlock& block, const double partial) const
+{
+    double result = 0.0;
+
+    for (size_t i = 0; i < block.genes.size(); ++i) {
+        const auto x = block.genes[i];
+        const auto sinArg = ((block.offset + i + 1) / std::numbers::pi) * x * x;
+        result += std::sin(x) * std::pow(std::sin(sinArg), 2 * m);
+    }
+
+    return partial - result;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <span>
+
+#include "genepool.h"
+#include "cpufeatures.h"
+
+//! Standard test functions, all minimized. Each one can be called per individual
+//! with a gene row or, as a batch fitness function, with a whole tile of rows; the
+//! batch path picks the widest SIMD kernel the CPU supports unless \a level caps it.
+//! The separable ones can also be folded over a genome block by block (see
+//! FitnessEvaluator::IsChunked), for genomes too long to decode in one piece.
+
+struct Sphere
+{
+    CpuFeatures::SimdLevel level = CpuFeatures::SimdLevel::Avx512;
+
+    double operator()(std::span<const double> x) const;
+    void operator()(const GeneTile& tile, std::span<double> fitness) const;
+    double operator()(const GeneBlock& block, const double partial) const;
+};
+
+struct Rastrigin
+{
+    CpuFeatures::SimdLevel level = CpuFeatures::SimdLevel::Avx512;
+
+    double operator()(std::span<const double> x) const;
+    void operator()(const GeneTile& tile, std::span<double> fitness) const;
+    double operator()(const GeneBlock& block, const double partial) const;
+};
+
+struct Rosenbrock
+{
+    CpuFeatures::SimdLevel level = CpuFeatures::SimdLevel::Avx512;
+
+    double operator()(std::span<const double> x) const;
+    void operator()(const GeneTile& tile, std::span<double> fitness) const;
+};
+
+struct Ackley
+{
+    CpuFeatures::SimdLevel level = CpuFeatures::SimdLevel::Avx512;
+
+    double operator()(std::span<const double> x) const;
+    void operator()(const GeneTile& tile, std::span<double> fitness) const;
+};
+
+struct Michalewicz
+{
+    //! Steepness of the valleys.
+    int m = 10;
+    CpuFeatures::SimdLevel level = CpuFeatures::SimdLevel::Avx512;
+
+    double operator()(std::span<const double> x) const;
+    void operator()(const GeneTile& tile, std::span<double> fitness) const;
+    double operator()(const GeneBlock& block, const double partial) const;
+};
@@ -0,0 +1,56 @@
+#include "cpufeatures.h"
+
+#include <algorithm>
+
+const CpuFeatures& CpuFeatures::get()
+{
+    static const CpuFeatures features;
+    return features;
+}
+
+CpuFeatures::CpuFeatures()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    m_avx2 = __builtin_cpu_supports("avx2");
+    m_fma = __builtin_cpu_supports("fma");
+    m_avx512f = __builtin_cpu_supports("avx512f");
+#endif
+}
+
+bool CpuFeatures::avx2() const
+{
+    return m_avx2;
+}
+
+bool CpuFeatures::fma() const
+{
+    return m_fma;
+}
+
+bool CpuFeatures::avx512f() const
+{
+    return m_avx512f;
+}
+
+CpuFeatures::SimdLevel CpuFeatures::best() const
+{
+#ifdef GENETIC_ALGO_AVX512
+    if (m_avx512f) {
+        return SimdLevel::Avx512;
+    }
+#endif
+
+#ifdef GENETIC_ALGO_AVX2
+    if (m_avx2 && m_fma) {
+        return SimdLevel::Avx2;
+    }
+#endif
+
+    return SimdLevel::Scalar;
+}
+
+CpuFeatures::SimdLevel CpuFeatures::resolve(const SimdLevel requested) const
+{
+    return std::min(requested, best());
+}
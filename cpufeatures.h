@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+//! Instruction sets the running CPU (and OS) supports, probed once at startup.
+class CpuFeatures final
+{
+public:
+    enum class SimdLevel
+    {
+        Scalar = 0,
+        Avx2,
+        Avx512
+    };
+
+    static const CpuFeatures& get();
+
+    bool avx2() const;
+    bool fma() const;
+    bool avx512f() const;
+
+    //! Widest level that is both supported here and compiled into the binary.
+    SimdLevel best() const;
+    //! Clamps a requested level to what best() allows.
+    SimdLevel resolve(const SimdLevel requested) const;
+
+private:
+    CpuFeatures();
+
+    bool m_avx2 = false;
+    bool m_fma = false;
+    bool m_avx512f = false;
+};
@@ -0,0 +1,119 @@
+#include "fitnesscache.h"
+
+#include <bit>
+#include <cstring>
+#include <algorithm>
+
+FitnessCache::FitnessCache(const size_t capacity)
+{
+    reset(capacity, 0);
+}
+
+void FitnessCache::reset(const size_t capacity, const size_t keyBytes)
+{
+    //! Whole sets, a power of two of them so the set is a mask of the hash.
+    const auto sets = capacity == 0 ? 0 : std::bit_ceil((capacity + Ways - 1) / Ways);
+
+    m_slots.assign(sets * Ways, Slot{});
+    m_keys.assign(sets * Ways * keyBytes, std::byte{});
+    m_victims.assign(sets, 0);
+    m_keyBytes = keyBytes;
+}
+
+std::optional<double> FitnessCache::find(std::span<const std::byte> key)
+{
+    if (m_slots.empty()) {
+        return std::nullopt;
+    }
+
+    const auto h = hash(key);
+    const auto first = set(h) * Ways;
+
+    for (size_t slot = first; slot < first + Ways; ++slot) {
+        if (m_slots[slot].used && m_slots[slot].hash == h && std::ranges::equal(this->key(slot), key)) {
+            ++m_hits;
+            return m_slots[slot].fitness;
+        }
+    }
+
+    ++m_misses;
+    return std::nullopt;
+}
+
+void FitnessCache::insert(std::span<const std::byte> key, const double fitness)
+{
+    if (m_slots.empty() || key.size() != m_keyBytes) {
+        return;
+    }
+
+    const auto h = hash(key);
+    const auto setIx = set(h);
+    const auto first = setIx * Ways;
+
+    auto target = first + Ways;
+
+    for (size_t slot = first; slot < first + Ways; ++slot) {
+        if (!m_slots[slot].used || (m_slots[slot].hash == h && std::ranges::equal(this->key(slot), key))) {
+            target = slot;
+            break;
+        }
+    }
+
+    if (target == first + Ways) {
+        target = first + m_victims[setIx];
+        m_victims[setIx] = (m_victims[setIx] + 1) % Ways;
+    }
+
+    m_slots[target] = Slot{h, fitness, true};
+    std::ranges::copy(key, this->key(target).begin());
+}
+
+size_t FitnessCache::capacity() const
+{
+    return m_slots.size();
+}
+
+size_t FitnessCache::keyBytes() const
+{
+    return m_keyBytes;
+}
+
+uint64_t FitnessCache::hits() const
+{
+    return m_hits;
+}
+
+uint64_t FitnessCache::misses() const
+{
+    return m_misses;
+}
+
+uint64_t FitnessCache::hash(std::span<const std::byte> key)
+{
+    //! Multiply-xorshift over 8-byte words; rows are whole doubles or code words.
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ key.size();
+
+    for (size_t i = 0; i + sizeof(uint64_t) <= key.size(); i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, key.data() + i, sizeof(word));
+
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 31;
+    }
+
+    for (size_t i = key.size() & ~(sizeof(uint64_t) - 1); i < key.size(); ++i) {
+        h = (h ^ std::to_integer<uint64_t>(key[i])) * 0x94D049BB133111EBull;
+    }
+
+    return h ^ (h >> 29);
+}
+
+size_t FitnessCache::set(const uint64_t hash) const
+{
+    return hash & (m_victims.size() - 1);
+}
+
+std::span<std::byte> FitnessCache::key(const size_t slot)
+{
+    return std::span<std::byte>(m_keys).subspan(slot * m_keyBytes, m_keyBytes);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+//! Bounded genome -> fitness memo keyed on the raw bytes of a row. It is 4-way set
+//! associative: a key can only live in the four slots of its set, and a full set
+//! evicts round robin, so lookups stay O(1) and memory stays fixed. Keys are compared
+//! in full, a hash collision never returns a wrong fitness. Not thread safe.
+class FitnessCache final
+{
+public:
+    explicit FitnessCache(const size_t capacity = 0);
+
+    //! Drops every entry and sizes the cache for \a capacity keys of \a keyBytes bytes.
+    void reset(const size_t capacity, const size_t keyBytes);
+
+    std::optional<double> find(std::span<const std::byte> key);
+    void insert(std::span<const std::byte> key, const double fitness);
+
+    size_t capacity() const;
+    size_t keyBytes() const;
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    static constexpr size_t Ways = 4;
+
+    struct Slot
+    {
+        uint64_t hash = 0;
+        double fitness = 0.0;
+        bool used = false;
+    };
+
+    static uint64_t hash(std::span<const std::byte> key);
+    size_t set(const uint64_t hash) const;
+    std::span<std::byte> key(const size_t slot);
+
+    std::vector<Slot> m_slots;
+    std::vector<std::byte> m_keys;
+    std::vector<uint8_t> m_victims;
+    size_t m_keyBytes = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
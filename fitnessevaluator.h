@@ -0,0 +1,469 @@
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "genepool.h"
+#include "threadpool.h"
+#include "surrogate.h"
+#include "fitnesscache.h"
+#include "geneticoperators.h"
+
+//! Runs a fitness function over the dirty rows of a gene pool (GenePool or BasicGenePool)
+//! and stores the results in the pool. Clean rows keep their fitness, so \a f has to be
+//! a pure function of the genes. With a cache, rows whose genes were seen before take
+//! their fitness from it. Gray code rows are decoded onto the bounds first and float or
+//! 16-bit real rows widened to doubles, so \a f always sees doubles. Decode buffers are
+//! kept between calls, one per worker.
+//!
+//! With a surrogate, the dirty rows are pre-screened: a model learnt from every real
+//! evaluation predicts their fitness, only the most promising fraction goes to \a f
+//! and the others take the prediction but stay dirty, so they are screened again
+//! (and may get evaluated) the next time round. Dirty means "not from \a f".
+//!
+//! A chunked fitness function sees a genome GeneticOperators::BlockGenes genes at a
+//! time, so Gray rows of any length are decoded into an L1-sized buffer rather than
+//! a whole row, and batch tiles are gathered at most MaxTileGenes genes at a time.
+class FitnessEvaluator final
+{
+public:
+    using Bounds = std::pair<double, double>;
+
+    //! A batch fitness function takes a tile of rows and writes one fitness per row,
+    //! f(const GeneTile&, std::span<double>). Anything else is called per individual.
+    template<class Func>
+    static constexpr bool IsBatch = std::is_invocable_v<const Func&, const GeneTile&, std::span<double>>;
+
+    //! A chunked fitness function folds over the blocks of a genome in order,
+    //! f(const GeneBlock&, double partial) -> double: the first block gets 0, the
+    //! value returned for the last one is the fitness. Batch functions take precedence.
+    template<class Func>
+    static constexpr bool IsChunked = std::is_invocable_r_v<double, const Func&, const GeneBlock&, double>;
+
+    static constexpr size_t MaxTileGenes = size_t{1} << 16;
+
+    template<class Pool, class Func>
+    void update(Pool& pool, const Func& f, const Bounds& bounds)
+    {
+        if (collect(pool, bounds)) {
+            evaluateRows(pool, f, 0, m_pending.size(), bounds, scratch(1).front());
+            store(pool, bounds);
+        }
+    }
+
+    //! Parallel version of the above: rows are handed out to the pool in chunks (tiles,
+    //! for batch functions). \a f is shared between the workers, so it has to be safe
+    //! to call concurrently. Every row is evaluated exactly once, so the result matches
+    //! the serial path.
+    template<class Pool, class Func>
+    void update(Pool& pool, const Func& f, const Bounds& bounds, ThreadPool& threads)
+    {
+        if (threads.size() == 1) {
+            return update(pool, f, bounds);
+        }
+
+        if (!collect(pool, bounds)) {
+            return;
+        }
+
+        auto& workers = scratch(threads.size());
+        const auto minGrain = size_t{IsBatch<Func> ? 64 : 1};
+        const auto grain = std::max(minGrain, m_pending.size() / (threads.size() * 8));
+
+        threads.parallelFor(m_pending.size(), grain, [&, this](const size_t begin, const size_t end, const size_t worker) {
+            evaluateRows(pool, f, begin, end, bounds, workers[worker]);
+        });
+
+        store(pool, bounds);
+    }
+
+    //! Evaluates row \a ix alone, if dirty, for pipelines that evaluate each child as it
+    //! is bred; the row is then clean when the next update() comes round. The cache is
+    //! consulted and filled, a surrogate learns from the result. Per individual and
+    //! chunked functions only, batch ones want tiles.
+    template<class Pool, class Func>
+    void updateRow(Pool& pool, const size_t ix, const Func& f, const Bounds& bounds)
+    {
+        static_assert(!IsBatch<Func>, "batch fitness functions are evaluated a tile at a time");
+
+        if (!pool.dirty(ix)) {
+            return;
+        }
+
+        ++m_ahead;
+        resizeCache(pool);
+
+        if (m_cacheCapacity > 0) {
+            if (const auto fitness = m_cache.find(pool.rowBytes(ix))) {
+                pool.setFitness(ix, *fitness);
+                pool.setDirty(ix, false);
+                return;
+            }
+        }
+
+        auto& genes = scratch(1).front().genes;
+        pool.setFitness(ix, evaluate(pool, f, ix, bounds, genes));
+        pool.setDirty(ix, false);
+        ++m_evaluations;
+
+        if (m_cacheCapacity > 0) {
+            m_cache.insert(pool.rowBytes(ix), pool.fitness(ix));
+        }
+
+        if (surrogateEnabled()) {
+            genes.resize(pool.dimentions());
+            decode(pool, ix, genes, bounds);
+            m_surrogate.learn(genes, pool.fitness(ix));
+        }
+    }
+
+    //! Sends only \a fraction of the changed rows, the best predicted, to the fitness
+    //! function once the surrogate has seen enough of them. The prediction is inverse
+    //! distance weighted over the \a neighbours nearest of the latest \a archive or so
+    //! evaluated genomes (see Surrogate). A fraction of 1 or more turns the surrogate off.
+    void setSurrogate(const double fraction, const size_t neighbours, const size_t archive = KdTree::DefaultCapacity)
+    {
+        m_surrogateFraction = fraction;
+        m_surrogate.reset(0, neighbours, archive);
+        m_surrogateNeighbours = neighbours;
+        m_surrogateArchive = archive;
+    }
+
+    //! Keeps up to \a capacity genomes with their fitness, 0 turns the cache off.
+    void setCacheCapacity(const size_t capacity)
+    {
+        m_cacheCapacity = capacity;
+        m_cache.reset(capacity, m_cache.keyBytes());
+    }
+
+    //! Calls of the fitness function, per row.
+    uint64_t evaluations() const { return m_evaluations; }
+    //! Counts \a count calls made outside the evaluator, by a local search, so that
+    //! budgets and telemetry see them.
+    void addEvaluations(const uint64_t count) { m_evaluations += count; }
+    //! Rows that kept their fitness because no operator changed them.
+    uint64_t skipped() const { return m_skipped; }
+    uint64_t cacheHits() const { return m_cache.hits(); }
+    uint64_t cacheMisses() const { return m_cache.misses(); }
+    //! Rows that took a surrogate prediction instead of a call.
+    uint64_t predictions() const { return m_predictions; }
+
+    //! Genes [firstGene, firstGene + out.size()) of row \a ix as real values: Gray codes
+    //! decoded onto \a bounds, real genes copied or widened.
+    template<class Pool>
+    static void decode(const Pool& pool, const size_t ix, std::span<double> out, const Bounds& bounds,
+                       const size_t firstGene = 0)
+    {
+        if constexpr (requires { pool.codes(ix); }) {
+            if (isGrayCode(pool)) {
+                GeneticOperators::decode(pool.codes(ix), pool.bitsPerGene(), out, bounds, firstGene);
+                return;
+            }
+        }
+
+        if constexpr (requires { pool.load(ix, out, firstGene); }) {
+            pool.load(ix, out, firstGene);
+        } else if constexpr (requires { pool.genes(ix); }) {
+            const auto genes = std::span<const double>(pool.genes(ix)).subspan(firstGene, out.size());
+            std::ranges::copy(genes, out.begin());
+        }
+    }
+
+    //! Inverse of decode: writes \a in as row \a ix, Gray genes encoded onto \a bounds,
+    //! real genes narrowed to the pool's precision.
+    template<class Pool>
+    static void encode(Pool& pool, const size_t ix, std::span<const double> in, const Bounds& bounds)
+    {
+        if constexpr (requires { pool.codes(ix); }) {
+            if (isGrayCode(pool)) {
+                const auto codes = pool.codes(ix);
+
+                for (size_t gene = 0; gene < in.size(); ++gene) {
+                    GeneticOperators::insert(codes, gene, pool.bitsPerGene(),
+                                             GeneticOperators::encode(in[gene], pool.bitsPerGene(), bounds));
+                }
+
+                return;
+            }
+        }
+
+        if constexpr (requires { pool.store(ix, in); }) {
+            pool.store(ix, in);
+        } else if constexpr (requires { pool.genes(ix); }) {
+            std::ranges::copy(in, pool.genes(ix).begin());
+        }
+    }
+
+    //! Fitness of one decoded genome, whatever kind of function \a f is.
+    template<class Func>
+    static double evaluate(const Func& f, std::span<const double> genes)
+    {
+        if constexpr (IsBatch<Func>) {
+            double fitness = 0.0;
+            f(GeneTile{genes, 1, genes.size()}, std::span<double>(&fitness, 1));
+            return fitness;
+        } else if constexpr (IsChunked<Func>) {
+            double partial = 0.0;
+
+            for (size_t begin = 0; begin < genes.size(); begin += GeneticOperators::BlockGenes) {
+                const auto count = std::min(GeneticOperators::BlockGenes, genes.size() - begin);
+                partial = f(GeneBlock{genes.subspan(begin, count), begin, genes.size()}, partial);
+            }
+
+            return partial;
+        } else {
+            return f(genes);
+        }
+    }
+
+private:
+    struct Scratch
+    {
+        std::vector<double> genes;
+        std::vector<double> fitness;
+    };
+
+    template<class Pool>
+    static bool isGrayCode(const Pool& pool)
+    {
+        return pool.type() == Individual::Type::GrayCode;
+    }
+
+    //! Real rows stored as doubles can be handed to \a f in place.
+    template<class Pool>
+    static bool inPlace(const Pool& pool)
+    {
+        if constexpr (requires { pool.precision(); }) {
+            if (pool.precision() != GenePool::Precision::Double) {
+                return false;
+            }
+        }
+
+        return !isGrayCode(pool);
+    }
+
+    bool surrogateEnabled() const { return m_surrogateFraction < 1.0; }
+
+    //! Gathers the dirty rows the cache cannot answer into m_pending, then lets the
+    //! surrogate drop all but the most promising. Returns whether there is anything
+    //! left to evaluate.
+    template<class Pool>
+    bool collect(Pool& pool, const Bounds& bounds)
+    {
+        m_pending.clear();
+        resizeCache(pool);
+
+        for (size_t i = 0; i < pool.size(); ++i) {
+            if (!pool.dirty(i)) {
+                //! Rows updateRow() got to first are not skips.
+                if (m_ahead > 0) {
+                    --m_ahead;
+                } else {
+                    ++m_skipped;
+                }
+
+                continue;
+            }
+
+            if (m_cacheCapacity > 0) {
+                if (const auto fitness = m_cache.find(pool.rowBytes(i))) {
+                    pool.setFitness(i, *fitness);
+                    pool.setDirty(i, false);
+                    continue;
+                }
+            }
+
+            m_pending.push_back(static_cast<uint32_t>(i));
+        }
+
+        m_ahead = 0;
+
+        if (surrogateEnabled()) {
+            screen(pool, bounds);
+        }
+
+        m_evaluations += m_pending.size();
+
+        return !m_pending.empty();
+    }
+
+    template<class Pool>
+    void resizeCache(const Pool& pool)
+    {
+        if (m_cacheCapacity > 0 && pool.size() > 0 && m_cache.keyBytes() != pool.rowBytes(0).size()) {
+            m_cache.reset(m_cacheCapacity, pool.rowBytes(0).size());
+        }
+    }
+
+    template<class Pool>
+    void screen(Pool& pool, const Bounds& bounds)
+    {
+        if (m_surrogate.size() == 0) {
+            m_surrogate.reset(pool.dimentions(), m_surrogateNeighbours, m_surrogateArchive);
+        }
+
+        if (!m_surrogate.ready() || m_pending.size() < 2) {
+            return;
+        }
+
+        auto& genes = scratch(1).front().genes;
+        genes.resize(pool.dimentions());
+
+        for (const auto i : m_pending) {
+            decode(pool, i, genes, bounds);
+            pool.setFitness(i, m_surrogate.predict(genes));
+        }
+
+        const auto fraction = std::max(m_surrogateFraction, 0.0);
+        const auto keep = std::clamp<size_t>(static_cast<size_t>(std::ceil(fraction * m_pending.size())), 1, m_pending.size());
+        const auto middle = m_pending.begin() + keep;
+
+        std::nth_element(m_pending.begin(), middle, m_pending.end(), [&pool](const auto a, const auto b) {
+            return pool.fitness(a) < pool.fitness(b);
+        });
+
+        m_predictions += m_pending.end() - middle;
+        m_pending.erase(middle, m_pending.end());
+        //! Back in row order, so runs of consecutive rows still make tiles.
+        std::ranges::sort(m_pending);
+    }
+
+    template<class Pool>
+    void store(Pool& pool, const Bounds& bounds)
+    {
+        for (const auto i : m_pending) {
+            if (m_cacheCapacity > 0) {
+                m_cache.insert(pool.rowBytes(i), pool.fitness(i));
+            }
+
+            pool.setDirty(i, false);
+        }
+
+        if (surrogateEnabled()) {
+            auto& genes = scratch(1).front().genes;
+            genes.resize(pool.dimentions());
+
+            for (const auto i : m_pending) {
+                decode(pool, i, genes, bounds);
+                m_surrogate.learn(genes, pool.fitness(i));
+            }
+        }
+    }
+
+    //! Evaluates m_pending[begin, end).
+    template<class Pool, class Func>
+    void evaluateRows(Pool& pool, const Func& f, const size_t begin, const size_t end, const Bounds& bounds,
+                      Scratch& scratch) const
+    {
+        const auto rows = std::span<const uint32_t>(m_pending).subspan(begin, end - begin);
+
+        if constexpr (IsBatch<Func>) {
+            //! Consecutive real rows are handed over in place, anything else is gathered.
+            if constexpr (requires { pool.tile(begin, end); }) {
+                if (inPlace(pool) && rows.back() - rows.front() + 1 == rows.size()) {
+                    f(pool.tile(rows.front(), rows.back() + 1), pool.fitnesses(rows.front(), rows.back() + 1));
+                    return;
+                }
+            }
+
+            const auto dimentions = pool.dimentions();
+            const auto rowsPerTile = std::max<size_t>(1, MaxTileGenes / std::max<size_t>(dimentions, 1));
+
+            for (size_t first = 0; first < rows.size(); first += rowsPerTile) {
+                const auto tile = rows.subspan(first, std::min(rowsPerTile, rows.size() - first));
+                scratch.genes.resize(tile.size() * dimentions);
+                scratch.fitness.resize(tile.size());
+
+                for (size_t k = 0; k < tile.size(); ++k) {
+                    decode(pool, tile[k], std::span<double>(scratch.genes).subspan(k * dimentions, dimentions), bounds);
+                }
+
+                f(GeneTile{scratch.genes, tile.size(), dimentions}, std::span<double>(scratch.fitness));
+
+                for (size_t k = 0; k < tile.size(); ++k) {
+                    pool.setFitness(tile[k], scratch.fitness[k]);
+                }
+            }
+        } else {
+            for (const auto i : rows) {
+                pool.setFitness(i, evaluate(pool, f, i, bounds, scratch.genes));
+            }
+        }
+    }
+
+    template<class Pool, class Func>
+    static double evaluate(const Pool& pool, const Func& f, const size_t ix, const Bounds& bounds, std::vector<double>& decoded)
+    {
+        if constexpr (IsChunked<Func>) {
+            return evaluateChunked(pool, f, ix, bounds, decoded);
+        } else {
+            if constexpr (requires { pool.genes(ix); } && std::is_invocable_v<const Func&, std::span<const double>>) {
+                if (inPlace(pool)) {
+                    return f(std::span<const double>(pool.genes(ix)));
+                }
+            }
+
+            decoded.resize(pool.dimentions());
+            decode(pool, ix, decoded, bounds);
+
+            return f(decoded);
+        }
+    }
+
+    template<class Pool, class Func>
+    static double evaluateChunked(const Pool& pool, const Func& f, const size_t ix, const Bounds& bounds,
+                                  std::vector<double>& decoded)
+    {
+        const auto dimentions = pool.dimentions();
+        double partial = 0.0;
+
+        decoded.resize(std::min(dimentions, GeneticOperators::BlockGenes));
+
+        for (size_t begin = 0; begin < dimentions; begin += GeneticOperators::BlockGenes) {
+            const auto count = std::min(GeneticOperators::BlockGenes, dimentions - begin);
+            auto block = std::span<const double>(decoded).first(count);
+
+            //! Real rows are read in place.
+            if constexpr (requires { pool.genes(ix); }) {
+                if (inPlace(pool)) {
+                    block = std::span<const double>(pool.genes(ix)).subspan(begin, count);
+                } else {
+                    decode(pool, ix, std::span<double>(decoded).first(count), bounds, begin);
+                }
+            } else {
+                decode(pool, ix, std::span<double>(decoded).first(count), bounds, begin);
+            }
+
+            partial = f(GeneBlock{block, begin, dimentions}, partial);
+        }
+
+        return partial;
+    }
+
+    std::vector<Scratch>& scratch(const size_t workers)
+    {
+        if (m_scratch.size() < workers) {
+            m_scratch.resize(workers);
+        }
+
+        return m_scratch;
+    }
+
+    std::vector<Scratch> m_scratch;
+    std::vector<uint32_t> m_pending;
+    FitnessCache m_cache;
+    size_t m_cacheCapacity = 0;
+    Surrogate m_surrogate;
+    double m_surrogateFraction = 1.0;
+    size_t m_surrogateNeighbours = 8;
+    size_t m_surrogateArchive = KdTree::DefaultCapacity;
+    uint64_t m_evaluations = 0;
+    uint64_t m_skipped = 0;
+    uint64_t m_predictions = 0;
+    uint64_t m_ahead = 0;
+};
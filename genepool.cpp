@@ -0,0 +1,354 @@
+#include "genepool.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+
+#include "geneticoperators.h"
+
+namespace
+{
+
+constexpr double FixedSteps = 65535.0;
+
+size_t geneBytes(const GenePool::Precision precision)
+{
+    switch (precision) {
+    case GenePool::Precision::Float:
+        return sizeof(float);
+    case GenePool::Precision::Fixed16:
+        return sizeof(uint16_t);
+    default:
+        return sizeof(double);
+    }
+}
+
+uint16_t quantize(const double value, const GenePool::Bounds& range)
+{
+    const auto scaled = (value - range.first) / (range.second - range.first) * FixedSteps;
+    return static_cast<uint16_t>(std::lround(std::clamp(scaled, 0.0, FixedSteps)));
+}
+
+} // namespace
+
+GenePool::GenePool(const size_t size, const size_t dimentions, const Individual::Type type,
+                   const uint8_t bitsPerGene, std::pmr::memory_resource* resource, const Precision precision,
+                   const Bounds& range)
+    : m_genes{resource}
+    , m_floats{resource}
+    , m_fixed{resource}
+    , m_codes{resource}
+    , m_fitness{resource}
+    , m_dirty{resource}
+    , m_size{size}
+    , m_dimentions{dimentions}
+    , m_type{type}
+    , m_bitsPerGene{bitsPerGene}
+    , m_wordsPerRow{GeneticOperators::wordsFor(dimentions, bitsPerGene)}
+    , m_precision{type == Individual::Type::GrayCode ? Precision::Double : precision}
+    , m_range{range}
+{
+    assert(bitsPerGene >= 1 && bitsPerGene <= 64);
+
+    if (type == Individual::Type::GrayCode) {
+        m_codes.resize(size * m_wordsPerRow);
+    } else if (m_precision == Precision::Float) {
+        m_floats.resize(size * dimentions);
+    } else if (m_precision == Precision::Fixed16) {
+        m_fixed.resize(size * dimentions);
+    } else {
+        m_genes.resize(size * dimentions);
+    }
+
+    m_fitness.resize(size);
+    m_dirty.resize(size, 1);
+}
+
+size_t GenePool::footprint(const size_t size, const size_t dimentions, const Individual::Type type,
+                           const uint8_t bitsPerGene, const Precision precision)
+{
+    const auto rowBytes = type == Individual::Type::GrayCode
+                              ? GeneticOperators::wordsFor(dimentions, bitsPerGene) * sizeof(Code)
+                              : dimentions * geneBytes(precision);
+    return size * rowBytes + size * sizeof(double) + size * sizeof(uint8_t);
+}
+
+std::span<double> GenePool::genes(const size_t ix)
+{
+    assert(ix < m_size && m_precision == Precision::Double);
+    return std::span<double>(m_genes).subspan(ix * m_dimentions, m_dimentions);
+}
+
+std::span<const double> GenePool::genes(const size_t ix) const
+{
+    assert(ix < m_size && m_precision == Precision::Double);
+    return std::span<const double>(m_genes).subspan(ix * m_dimentions, m_dimentions);
+}
+
+double GenePool::gene(const size_t ix, const size_t gene) const
+{
+    assert(ix < m_size && gene < m_dimentions);
+    const auto at = ix * m_dimentions + gene;
+
+    switch (m_precision) {
+    case Precision::Float:
+        return m_floats[at];
+    case Precision::Fixed16:
+        return m_range.first + m_fixed[at] * ((m_range.second - m_range.first) / FixedSteps);
+    default:
+        return m_genes[at];
+    }
+}
+
+void GenePool::setGene(const size_t ix, const size_t gene, const double value)
+{
+    assert(ix < m_size && gene < m_dimentions);
+    const auto at = ix * m_dimentions + gene;
+
+    switch (m_precision) {
+    case Precision::Float:
+        m_floats[at] = static_cast<float>(value);
+        break;
+    case Precision::Fixed16:
+        m_fixed[at] = quantize(value, m_range);
+        break;
+    default:
+        m_genes[at] = value;
+    }
+}
+
+void GenePool::load(const size_t ix, std::span<double> out, const size_t firstGene) const
+{
+    assert(ix < m_size && firstGene + out.size() <= m_dimentions);
+    const auto at = ix * m_dimentions + firstGene;
+
+    switch (m_precision) {
+    case Precision::Float:
+        std::copy_n(m_floats.begin() + at, out.size(), out.begin());
+        break;
+    case Precision::Fixed16: {
+        const auto low = m_range.first;
+        const auto step = (m_range.second - m_range.first) / FixedSteps;
+
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = low + m_fixed[at + i] * step;
+        }
+
+        break;
+    }
+    default:
+        std::copy_n(m_genes.begin() + at, out.size(), out.begin());
+    }
+}
+
+void GenePool::store(const size_t ix, std::span<const double> in, const size_t firstGene)
+{
+    assert(ix < m_size && firstGene + in.size() <= m_dimentions);
+    const auto at = ix * m_dimentions + firstGene;
+
+    switch (m_precision) {
+    case Precision::Float:
+        std::ranges::transform(in, m_floats.begin() + at, [](const double value) { return static_cast<float>(value); });
+        break;
+    case Precision::Fixed16:
+        std::ranges::transform(in, m_fixed.begin() + at, [this](const double value) { return quantize(value, m_range); });
+        break;
+    default:
+        std::ranges::copy(in, m_genes.begin() + at);
+    }
+}
+
+std::span<GenePool::Code> GenePool::codes(const size_t ix)
+{
+    assert(ix < m_size);
+    return std::span<Code>(m_codes).subspan(ix * m_wordsPerRow, m_wordsPerRow);
+}
+
+std::span<const GenePool::Code> GenePool::codes(const size_t ix) const
+{
+    assert(ix < m_size);
+    return std::span<const Code>(m_codes).subspan(ix * m_wordsPerRow, m_wordsPerRow);
+}
+
+GenePool::Code GenePool::code(const size_t ix, const size_t gene) const
+{
+    assert(gene < m_dimentions);
+    return GeneticOperators::extract(codes(ix), gene, m_bitsPerGene);
+}
+
+void GenePool::setCode(const size_t ix, const size_t gene, const Code code)
+{
+    assert(gene < m_dimentions);
+    GeneticOperators::insert(codes(ix), gene, m_bitsPerGene, code);
+}
+
+void GenePool::setFitness(const size_t ix, const double val)
+{
+    m_fitness[ix] = val;
+}
+
+double GenePool::fitness(const size_t ix) const
+{
+    return m_fitness[ix];
+}
+
+std::span<const double> GenePool::fitnesses() const
+{
+    return m_fitness;
+}
+
+std::span<double> GenePool::fitnesses(const size_t begin, const size_t end)
+{
+    assert(begin <= end && end <= m_size);
+    return std::span<double>(m_fitness).subspan(begin, end - begin);
+}
+
+bool GenePool::dirty(const size_t ix) const
+{
+    return m_dirty[ix];
+}
+
+void GenePool::setDirty(const size_t ix, const bool dirty)
+{
+    m_dirty[ix] = dirty;
+}
+
+void GenePool::setAllDirty()
+{
+    std::ranges::fill(m_dirty, 1);
+}
+
+std::span<const std::byte> GenePool::rowBytes(const size_t ix) const
+{
+    return const_cast<GenePool*>(this)->writableRowBytes(ix);
+}
+
+std::span<std::byte> GenePool::writableRowBytes(const size_t ix)
+{
+    assert(ix < m_size);
+
+    if (m_type == Individual::Type::GrayCode) {
+        return std::as_writable_bytes(codes(ix));
+    }
+
+    switch (m_precision) {
+    case Precision::Float:
+        return std::as_writable_bytes(std::span<float>(m_floats).subspan(ix * m_dimentions, m_dimentions));
+    case Precision::Fixed16:
+        return std::as_writable_bytes(std::span<uint16_t>(m_fixed).subspan(ix * m_dimentions, m_dimentions));
+    default:
+        return std::as_writable_bytes(genes(ix));
+    }
+}
+
+bool GenePool::sameRow(const size_t ix, const GenePool& other, const size_t otherIx) const
+{
+    return std::ranges::equal(rowBytes(ix), other.rowBytes(otherIx));
+}
+
+GeneTile GenePool::tile(const size_t begin, const size_t end) const
+{
+    assert(begin <= end && end <= m_size && m_precision == Precision::Double);
+    return GeneTile{std::span<const double>(m_genes).subspan(begin * m_dimentions, (end - begin) * m_dimentions),
+                    end - begin, m_dimentions};
+}
+
+void GenePool::copyRow(const size_t ix, const GenePool& from, const size_t fromIx)
+{
+    assert(from.m_type == m_type && from.m_dimentions == m_dimentions && from.m_bitsPerGene == m_bitsPerGene
+           && from.m_precision == m_precision);
+
+    std::ranges::copy(from.rowBytes(fromIx), writableRowBytes(ix).begin());
+
+    m_fitness[ix] = from.m_fitness[fromIx];
+    m_dirty[ix] = from.m_dirty[fromIx];
+}
+
+GenePool GenePool::withSize(const size_t size) const
+{
+    return GenePool(size, m_dimentions, m_type, m_bitsPerGene, std::pmr::get_default_resource(), m_precision, m_range);
+}
+
+Individual GenePool::individual(const size_t ix) const
+{
+    Individual ind(m_dimentions, m_type, m_bitsPerGene);
+
+    if (m_type == Individual::Type::GrayCode) {
+        for (size_t gene = 0; gene < m_dimentions; ++gene) {
+            ind.appendCode(code(ix, gene));
+        }
+    } else {
+        for (size_t g = 0; g < m_dimentions; ++g) {
+            ind.append(gene(ix, g));
+        }
+    }
+
+    ind.setFitness(m_fitness[ix]);
+
+    return ind;
+}
+
+void GenePool::setIndividual(const size_t ix, const Individual& ind)
+{
+    const auto& chromosomes = ind.chromosomes();
+
+    if (std::holds_alternative<Individual::Gene>(chromosomes)) {
+        store(ix, std::get<Individual::Gene>(chromosomes));
+    } else {
+        const auto& grayCode = std::get<Individual::GrayCode>(chromosomes);
+        std::ranges::fill(codes(ix), Code{0});
+
+        for (size_t gene = 0; gene < grayCode.size(); ++gene) {
+            setCode(ix, gene, grayCode[gene]);
+        }
+    }
+
+    m_fitness[ix] = ind.fitness();
+    m_dirty[ix] = 1;
+}
+
+size_t GenePool::size() const
+{
+    return m_size;
+}
+
+size_t GenePool::dimentions() const
+{
+    return m_dimentions;
+}
+
+Individual::Type GenePool::type() const
+{
+    return m_type;
+}
+
+uint8_t GenePool::bitsPerGene() const
+{
+    return m_bitsPerGene;
+}
+
+GenePool::Precision GenePool::precision() const
+{
+    return m_precision;
+}
+
+const GenePool::Bounds& GenePool::range() const
+{
+    return m_range;
+}
+
+size_t GenePool::wordsPerRow() const
+{
+    return m_wordsPerRow;
+}
+
+bool GenePool::sameShape(const GenePool& other) const
+{
+    return m_size == other.m_size && m_dimentions == other.m_dimentions && m_type == other.m_type
+           && m_bitsPerGene == other.m_bitsPerGene && m_precision == other.m_precision && m_range == other.m_range;
+}
+
+std::string GenePool::toString(const size_t ix) const
+{
+    return individual(ix).toString();
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <memory_resource>
+
+#include "individual.h"
+
+//! Read-only view of consecutive rows of a gene matrix, handed to batch fitness functions.
+struct GeneTile
+{
+    std::span<const double> genes;
+    size_t rows = 0;
+    size_t dimentions = 0;
+
+    std::span<const double> row(const size_t ix) const
+    {
+        return genes.subspan(ix * dimentions, dimentions);
+    }
+};
+
+//! Consecutive genes [offset, offset + genes.size()) of one genome of \a dimentions
+//! genes, handed to chunked fitness functions.
+struct GeneBlock
+{
+    std::span<const double> genes;
+    size_t offset = 0;
+    size_t dimentions = 0;
+};
+
+//! Contiguous storage of a whole generation: one row-major gene matrix
+//! (size x dimentions) and a separate fitness array. Real genes live in a
+//! matrix of doubles, floats or 16-bit fixed point values (see Precision), Gray
+//! code genes in packed rows of 64-bit words, bitsPerGene() bits per gene (see
+//! GeneticOperators::extract/insert).
+//! Storage comes from \a resource, assigning a pool of the same shape reuses it.
+//! A row costs its genes or codes plus 9 bytes (fitness and dirty flag), nothing per
+//! gene, see footprint().
+class GenePool final
+{
+public:
+    using Code = uint64_t;
+    using Bounds = std::pair<double, double>;
+
+    //! How real genes are stored: as doubles, as floats, or quantized to 65536 evenly
+    //! spaced values over \a range. Rows of the narrower ones are half and a quarter
+    //! the size; they are read and written as doubles through gene()/load() and
+    //! setGene()/store(), genes() and tile() are for Double rows only.
+    enum class Precision
+    {
+        Double = 0,
+        Float,
+        Fixed16
+    };
+
+    GenePool(const size_t size = 0, const size_t dimentions = 0, const Individual::Type type = Individual::Type::Discrete,
+             const uint8_t bitsPerGene = 8, std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+             const Precision precision = Precision::Double, const Bounds& range = {0.0, 1.0});
+
+    //! Bytes a pool of this shape takes from its memory resource.
+    static size_t footprint(const size_t size, const size_t dimentions, const Individual::Type type,
+                            const uint8_t bitsPerGene = 8, const Precision precision = Precision::Double);
+
+    std::span<double> genes(const size_t ix);
+    std::span<const double> genes(const size_t ix) const;
+
+    //! Real gene \a gene of row \a ix, whatever the precision. Values outside the
+    //! range are clamped into it by Fixed16 rows.
+    double gene(const size_t ix, const size_t gene) const;
+    void setGene(const size_t ix, const size_t gene, const double value);
+    //! Real genes [firstGene, firstGene + out.size()) of row \a ix, as doubles.
+    void load(const size_t ix, std::span<double> out, const size_t firstGene = 0) const;
+    void store(const size_t ix, std::span<const double> in, const size_t firstGene = 0);
+
+    //! Packed words of row \a ix.
+    std::span<Code> codes(const size_t ix);
+    std::span<const Code> codes(const size_t ix) const;
+
+    //! Gray code of a single gene.
+    Code code(const size_t ix, const size_t gene) const;
+    void setCode(const size_t ix, const size_t gene, const Code code);
+
+    void setFitness(const size_t ix, const double val);
+    double fitness(const size_t ix) const;
+    std::span<const double> fitnesses() const;
+    std::span<double> fitnesses(const size_t begin, const size_t end);
+
+    //! A row is dirty while its fitness does not belong to its genes; new rows start dirty.
+    //! The genetic operators set it, FitnessEvaluator only evaluates dirty rows and clears it.
+    bool dirty(const size_t ix) const;
+    void setDirty(const size_t ix, const bool dirty);
+    void setAllDirty();
+
+    //! Raw bytes of row \a ix, genes or packed codes depending on the type.
+    std::span<const std::byte> rowBytes(const size_t ix) const;
+    std::span<std::byte> writableRowBytes(const size_t ix);
+    //! Whether row \a ix holds exactly the same genes as row \a otherIx of \a other.
+    bool sameRow(const size_t ix, const GenePool& other, const size_t otherIx) const;
+
+    //! Real gene rows [begin, end).
+    GeneTile tile(const size_t begin, const size_t end) const;
+
+    //! Copies row \a fromIx of \a from into row \a ix, fitness and dirty flag included.
+    void copyRow(const size_t ix, const GenePool& from, const size_t fromIx);
+
+    //! Empty pool of the same shape with \a size rows, on the default resource.
+    GenePool withSize(const size_t size) const;
+
+    //! Materializes a standalone Individual out of row \a ix.
+    Individual individual(const size_t ix) const;
+    void setIndividual(const size_t ix, const Individual& ind);
+
+    size_t size() const;
+    size_t dimentions() const;
+    Individual::Type type() const;
+    uint8_t bitsPerGene() const;
+    Precision precision() const;
+    const Bounds& range() const;
+    //! Packed words per Gray code row.
+    size_t wordsPerRow() const;
+    bool sameShape(const GenePool& other) const;
+
+    std::string toString(const size_t ix) const;
+
+private:
+    std::pmr::vector<double> m_genes;
+    std::pmr::vector<float> m_floats;
+    std::pmr::vector<uint16_t> m_fixed;
+    std::pmr::vector<Code> m_codes;
+    std::pmr::vector<double> m_fitness;
+    std::pmr::vector<uint8_t> m_dirty;
+    size_t m_size;
+    size_t m_dimentions;
+    Individual::Type m_type;
+    uint8_t m_bitsPerGene;
+    size_t m_wordsPerRow;
+    Precision m_precision;
+    Bounds m_range;
+};
@@ -1,2 +1,14 @@
 #include "geneticalgo.h"
 
+#include <algorithm>
+
+ThreadPool& GeneticAlgo::threadPool(const uint32_t threads)
+{
+    const size_t size = std::max<uint32_t>(threads, 1);
+
+    if (!m_pool || m_pool->size() != size) {
+        m_pool = std::make_unique<ThreadPool>(size);
+    }
+
+    return *m_pool;
+}
@@ -2,9 +2,27 @@
 
 #define _USE_MATH_DEFINES
 #include <math.h>
-#include <iostream>
+#include <atomic>
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <limits>
+#include <functional>
+#include <span>
+#include <vector>
+#include <algorithm>
 
+#include "migration.h"
+#include "pareto.h"
+#include "localsearch.h"
+#include "snapshot.h"
 #include "population.h"
+#include "basicpopulation.h"
+#include "statistics.h"
+#include "telemetry.h"
+#include "allocationcounter.h"
 
 class GeneticAlgo final
 {
@@ -12,83 +30,1158 @@ public:
     struct PopulationSettings
     {
         uint32_t size;
-        uint8_t dimentions;
+        size_t dimentions;
         Population::IndividualType type;
         Population::Bounds bounds;
         Population::SelectionType selection;
+        //! How rank and proportional selection draw their parents.
+        Population::SamplingType sampling = Population::SamplingType::Roulette;
         Population::CrossoverType crossover;
+        //! Per individual: chance that one random gene (one bit for Gray codes) mutates.
         double mutationChance;
+        //! Sparse per-gene mutation on top of the above, per bit for Gray codes (BitFlip),
+        //! None turns it off. Real genes take Uniform, Gaussian or Polynomial.
+        Population::MutationType mutation = Population::MutationType::None;
+        double mutationRate = 0.0;
+        //! Chance that a pair of parents is crossed, otherwise the children are copies.
+        double crossoverRate = 1.0;
+        //! Self-adaptive rates: while the population diversity is under targetDiversity
+        //! the mutation rates go up (up to 16x) and the crossover rate down (to half);
+        //! above it they relax back, mutation down to a quarter. Generational runs only.
+        bool adaptiveRates = false;
+        double targetDiversity = 0.05;
+        //! Breeds a pair at a time instead of phase by phase: two parents are drawn, crossed
+        //! into their slots and the children mutated, then evaluated while still in cache
+        //! when the fitness function is per individual or chunked, the run is serial and
+        //! there is no surrogate. Another order of random draws, so other results than the
+        //! phased pipeline for the same seed. Telemetry counts the pass as crossover time.
+        bool fused = false;
+        //! Gray code resolution, 1 to 64 bits per gene.
+        uint8_t bitsPerGene = 8;
+        //! Storage of real genes: Float halves gene memory and bandwidth, Fixed16 quarters
+        //! it by quantizing onto bounds in 65536 steps. Operators and the fitness function
+        //! still see doubles. Runtime-encoded runs only.
+        Population::GenePrecision precision = Population::GenePrecision::Double;
+        //! Genome -> fitness cache entries, 0 evaluates every changed genome.
+        size_t fitnessCache = 0;
+        //! Fraction of the changed genomes, the best predicted by a k nearest neighbour
+        //! surrogate, that go to the fitness function; the others keep the prediction.
+        //! 1 turns the surrogate off. See FitnessEvaluator::setSurrogate.
+        double surrogateFraction = 1.0;
+        uint32_t surrogateNeighbours = 8;
+        //! Evaluated genomes the surrogate remembers, the latest ones.
+        size_t surrogateArchive = KdTree::DefaultCapacity;
+        //! Memetic stage of generational runs: once an epoch's population is evaluated, a
+        //! bounded local search (localSearch.method) improves its localSearch.elites
+        //! fittest individuals, one per task on settings.threads threads, so \a func has
+        //! to be safe to call concurrently then. Every call counts as an evaluation, for
+        //! the budgets and the telemetry alike. None (the default) turns it off.
+        LocalSearch::Settings localSearch;
+        //! Where children go in a steady-state run.
+        Population::ReplacementType replacement = Population::ReplacementType::Worst;
+        //! Threads used for fitness evaluation, 1 keeps it on the calling thread.
+        uint32_t threads = 1;
+        //! Every random draw of a run derives from this seed, runs with the same seed
+        //! replay exactly whatever the thread count.
+        uint64_t seed = 0;
     };
 
-    GeneticAlgo(const uint8_t epochs)
+    //! Island model: several populations of the same settings evolve side by side, one
+    //! per thread. Every interval epochs each island sends copies of its fittest
+    //! individuals to its neighbours, which take them in at their next epoch. Nothing
+    //! waits on anything, islands only meet through their mailboxes; the result depends
+    //! on thread timing, so it does not replay exactly from the seed.
+    struct IslandSettings
+    {
+        uint32_t islands = 4;
+        IslandTopology topology = IslandTopology::Ring;
+        uint32_t interval = 10;
+        uint32_t migrants = 2;
+    };
+
+    //! Batch of independent runs of the same settings, spread over a thread pool (0
+    //! uses every hardware thread). Run i draws from stream i of settings.seed, so a
+    //! batch replays exactly whatever the thread count. Each run evaluates its fitness
+    //! on its own thread, settings.threads is ignored.
+    struct BatchSettings
+    {
+        uint32_t runs = 100;
+        uint32_t threads = 0;
+    };
+
+    template<class IndividualType>
+    struct BatchRun
+    {
+        IndividualType best;
+        //! Fitness function calls, up to the target when it was reached.
+        uint64_t evaluations = 0;
+        double seconds = 0.0;
+        bool reachedTarget = false;
+    };
+
+    template<class IndividualType>
+    struct BatchResult
+    {
+        //! In run order.
+        std::vector<BatchRun<IndividualType>> runs;
+        IndividualType best;
+        //! Best fitness of every run, none for an empty batch.
+        std::optional<Statistics::Quantiles> fitness;
+        //! Over the runs that reached the target only, none when no run did.
+        uint32_t reachedTarget = 0;
+        std::optional<Statistics::Quantiles> evaluationsToTarget;
+        std::optional<Statistics::Quantiles> secondsToTarget;
+    };
+
+    //! Result of a multi-objective run: the non-dominated individuals of the last
+    //! generation, duplicates dropped, ordered by their objectives.
+    template<class IndividualType>
+    struct ParetoArchive
+    {
+        std::vector<IndividualType> individuals;
+        //! Row-major, objectives values per individual.
+        std::vector<double> values;
+        uint32_t objectives = 0;
+
+        std::span<const double> objectivesOf(const size_t ix) const
+        {
+            return std::span<const double>(values).subspan(ix * objectives, objectives);
+        }
+    };
+
+    //! When a run stops besides reaching its target or its epoch budget, a criterion
+    //! being off while 0. Steady-state runs only honour the evaluation and time budgets.
+    struct Termination
+    {
+        //! Epochs in a row in which the best fitness did not improve by more than stallTolerance.
+        uint64_t stallEpochs = 0;
+        double stallTolerance = 0.0;
+        //! Converged: population diversity (see Statistics::diversity) under this.
+        double minDiversity = 0.0;
+        //! Calls of the fitness function.
+        uint64_t maxEvaluations = 0;
+        double maxSeconds = 0.0;
+        //! Anything else: called after every epoch's evaluation, true stops the run.
+        //! Island and batch runs call it from several threads at once.
+        std::function<bool(const EpochStats&)> stop;
+    };
+
+    GeneticAlgo(const uint64_t epochs)
         : m_epochs{epochs}
     {}
 
+    //! Per-epoch statistics go to \a telemetry, which has to outlive the runs.
+    //! Telemetry::none() (the default) turns them off.
+    void setTelemetry(Telemetry& telemetry) { m_telemetry = &telemetry; }
+
+    void setTermination(Termination termination) { m_termination = std::move(termination); }
+
+    //! run() and resume() save a Snapshot to \a path every \a interval epochs, written
+    //! in the background; a snapshot falling due while the previous one is still being
+    //! written is skipped. An empty path or interval 0 turns checkpoints off.
+    void setCheckpoint(const std::string& path, const uint32_t interval)
+    {
+        m_checkpoint = path.empty() || interval == 0 ? nullptr : std::make_unique<SnapshotWriter>(path);
+        m_checkpointInterval = interval;
+    }
+
     template<class FitnessFunc>
     Individual run(const PopulationSettings& settings, FitnessFunc func, const double target)
     {
-        Population population(settings.size, settings.dimentions, settings.type, settings.bounds);
-        std::cout << population.toString();
+        //! Successive runs of one GeneticAlgo get their own streams of the seed.
+        Population population(settings.size, settings.dimentions, settings.type, settings.bounds,
+                              settings.bitsPerGene, Random(settings.seed, m_runs++), settings.precision);
+        configure(population, settings);
+        return finish(evolve(population, settings, func, target, threadPool(settings.threads), 0, checkpointer(population)));
+    }
+
+    //! Same as above with the encoding and the dimension fixed at compile time,
+    //! settings.type, settings.dimentions and settings.bitsPerGene are ignored.
+    template<class Encoding, size_t Dim, class FitnessFunc>
+    BasicIndividual<Encoding, Dim> run(const PopulationSettings& settings, FitnessFunc func, const double target)
+    {
+        BasicPopulation<Encoding, Dim> population(settings.size, settings.bounds, Random(settings.seed, m_runs++));
+        configure(population, settings);
+        return finish(evolve(population, settings, func, target, threadPool(settings.threads), 0, checkpointer(population)));
+    }
+
+    //! Continues the run checkpointed to \a path, which has to match \a settings, up to
+    //! the epochs of this GeneticAlgo. The population, random stream, best individual,
+    //! epoch, evaluation count, stall state and adaptive rates come from the snapshot,
+    //! so the run ends where the uninterrupted one does (resumetest.cpp checks it).
+    //! The fitness cache and the surrogate start empty though: with either on, or with
+    //! a time limit, the resumed run may take another course.
+    template<class FitnessFunc>
+    Individual resume(const PopulationSettings& settings, const std::string& path, FitnessFunc func, const double target)
+    {
+        Population population(0, settings.dimentions, settings.type, settings.bounds, settings.bitsPerGene, Random{},
+                              settings.precision);
+        GenePool individuals(settings.size, settings.dimentions, static_cast<Individual::Type>(settings.type),
+                             settings.bitsPerGene, std::pmr::get_default_resource(), settings.precision, settings.bounds);
+        return restore(population, std::move(individuals), settings, path, func, target);
+    }
+
+    template<class Encoding, size_t Dim, class FitnessFunc>
+    BasicIndividual<Encoding, Dim> resume(const PopulationSettings& settings, const std::string& path, FitnessFunc func,
+                                          const double target)
+    {
+        BasicPopulation<Encoding, Dim> population(0, settings.bounds);
+        BasicGenePool<Encoding, Dim> individuals(settings.size);
+        return restore(population, std::move(individuals), settings, path, func, target);
+    }
+
+    //! Island model run, the best individual over all islands. Every island evaluates
+    //! its fitness on its own thread, settings.threads is ignored. Stops all islands
+    //! as soon as one of them reaches \a target.
+    template<class FitnessFunc>
+    Individual runIslands(const PopulationSettings& settings, const IslandSettings& islands, FitnessFunc func, const double target)
+    {
+        std::vector<Population> populations;
+        populations.reserve(islands.islands);
+
+        for (uint32_t i = 0; i < islands.islands; ++i) {
+            populations.emplace_back(settings.size, settings.dimentions, settings.type, settings.bounds,
+                                     settings.bitsPerGene, Random(settings.seed, m_runs++), settings.precision);
+            configure(populations.back(), settings);
+        }
+
+        return evolveIslands(populations, settings, islands, func, target);
+    }
+
+    template<class Encoding, size_t Dim, class FitnessFunc>
+    BasicIndividual<Encoding, Dim> runIslands(const PopulationSettings& settings, const IslandSettings& islands,
+                                              FitnessFunc func, const double target)
+    {
+        std::vector<BasicPopulation<Encoding, Dim>> populations;
+        populations.reserve(islands.islands);
+
+        for (uint32_t i = 0; i < islands.islands; ++i) {
+            populations.emplace_back(settings.size, settings.bounds, Random(settings.seed, m_runs++));
+            configure(populations.back(), settings);
+        }
+
+        return evolveIslands(populations, settings, islands, func, target);
+    }
+
+    template<class FitnessFunc>
+    BatchResult<Individual> runBatch(const PopulationSettings& settings, const BatchSettings& batch, FitnessFunc func,
+                                     const double target)
+    {
+        return evolveBatch(settings, batch, func, target, [&settings](const uint64_t run) {
+            Population population(settings.size, settings.dimentions, settings.type, settings.bounds,
+                                  settings.bitsPerGene, Random(settings.seed, run), settings.precision);
+            configure(population, settings);
+            return population;
+        });
+    }
+
+    template<class Encoding, size_t Dim, class FitnessFunc>
+    BatchResult<BasicIndividual<Encoding, Dim>> runBatch(const PopulationSettings& settings, const BatchSettings& batch,
+                                                         FitnessFunc func, const double target)
+    {
+        return evolveBatch(settings, batch, func, target, [&settings](const uint64_t run) {
+            BasicPopulation<Encoding, Dim> population(settings.size, settings.bounds, Random(settings.seed, run));
+            configure(population, settings);
+            return population;
+        });
+    }
+
+    //! Steady-state run: instead of generations, settings.threads workers each keep one
+    //! pair of children in evaluation. Whenever a pair comes back it is put into the
+    //! population by settings.replacement and the worker breeds the next one right away
+    //! from the current population, so a slow evaluation holds up nobody else. Parents
+    //! come from settings.selection, refreshed every size() / 2 pairs. The budget is
+    //! size * epochs evaluations; children identical to a parent are not evaluated nor
+    //! inserted. Results depend on thread timing. \a func has to be safe to call
+    //! concurrently. Telemetry gets one record per size() evaluations.
+    template<class FitnessFunc>
+    Individual runSteadyState(const PopulationSettings& settings, FitnessFunc func, const double target)
+    {
+        Population population(settings.size, settings.dimentions, settings.type, settings.bounds,
+                              settings.bitsPerGene, Random(settings.seed, m_runs++), settings.precision);
+        configure(population, settings);
+        return steadyState(population, settings, func, target);
+    }
+
+    template<class Encoding, size_t Dim, class FitnessFunc>
+    BasicIndividual<Encoding, Dim> runSteadyState(const PopulationSettings& settings, FitnessFunc func, const double target)
+    {
+        BasicPopulation<Encoding, Dim> population(settings.size, settings.bounds, Random(settings.seed, m_runs++));
+        configure(population, settings);
+        return steadyState(population, settings, func, target);
+    }
+
+    //! Multi-objective run, NSGA-II: \a func writes the \a objectives values of an
+    //! individual, all minimized, f(std::span<const double> genes, std::span<double> objectives).
+    //! Parents come from binary tournaments on front and crowding distance (settings.selection
+    //! and sampling are ignored) and every epoch the best size() of parents and children
+    //! survive, see Pareto::select. An individual's fitness is its front. Only changed
+    //! children are evaluated, on settings.threads threads, so \a func has to be safe to
+    //! call concurrently then; the cache, the surrogate and the fused pipeline do not
+    //! apply. All epochs run unless a Termination criterion other than stalling holds;
+    //! telemetry's best, mean and stddev are over the first objective.
+    template<class ObjectiveFunc>
+    ParetoArchive<Individual> runPareto(const PopulationSettings& settings, const uint32_t objectives, ObjectiveFunc func)
+    {
+        Population population(settings.size, settings.dimentions, settings.type, settings.bounds,
+                              settings.bitsPerGene, Random(settings.seed, m_runs++), settings.precision);
+        return pareto(population, settings, objectives, func, threadPool(settings.threads));
+    }
+
+    template<class Encoding, size_t Dim, class ObjectiveFunc>
+    ParetoArchive<BasicIndividual<Encoding, Dim>> runPareto(const PopulationSettings& settings, const uint32_t objectives,
+                                                            ObjectiveFunc func)
+    {
+        BasicPopulation<Encoding, Dim> population(settings.size, settings.bounds, Random(settings.seed, m_runs++));
+        return pareto(population, settings, objectives, func, threadPool(settings.threads));
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    //! Nanoseconds since \a since, which moves on to now; free when not \a tracing.
+    static double lap(const bool tracing, Clock::time_point& since)
+    {
+        if (!tracing) {
+            return 0.0;
+        }
+
+        const auto now = Clock::now();
+        const auto elapsed = std::chrono::duration<double, std::nano>(now - since).count();
+        since = now;
+
+        return elapsed;
+    }
+
+    template<class PopulationType>
+    static void configure(PopulationType& population, const PopulationSettings& settings)
+    {
+        population.setFitnessCache(settings.fitnessCache);
+        population.setSurrogate(settings.surrogateFraction, settings.surrogateNeighbours, settings.surrogateArchive);
+    }
+
+    //! Multipliers of the configured operator rates, see PopulationSettings::adaptiveRates.
+    struct Rates
+    {
+        double mutation = 1.0;
+        double crossover = 1.0;
+
+        void adapt(const double diversity, const double target)
+        {
+            if (diversity < target) {
+                mutation = std::min(mutation * 1.5, 16.0);
+                crossover = std::max(crossover * 0.8, 0.5);
+            } else {
+                mutation = std::max(mutation / 1.5, 0.25);
+                crossover = std::min(crossover / 0.8, 1.0);
+            }
+        }
+
+        PopulationSettings apply(PopulationSettings settings) const
+        {
+            settings.mutationChance = std::min(settings.mutationChance * mutation, 1.0);
+            settings.mutationRate = std::min(settings.mutationRate * mutation, 1.0);
+            settings.crossoverRate = std::min(settings.crossoverRate * crossover, 1.0);
+            return settings;
+        }
+    };
+
+    //! Mutates rows [begin, end) of \a individuals, all of them by default.
+    template<class PopulationType>
+    static void mutate(PopulationType& population, typename PopulationType::Individuals& individuals,
+                       const PopulationSettings& settings, const size_t begin = 0, const size_t end = SIZE_MAX)
+    {
+        if (settings.mutationChance > 0.0) {
+            for (size_t i = begin; i < std::min(end, individuals.size()); ++i) {
+                population.mutate(individuals, i, settings.mutationChance);
+            }
+        }
+
+        if (settings.mutation != Population::MutationType::None
+            && !population.mutate(individuals, settings.mutation, settings.mutationRate, begin, end)) {
+            throw std::runtime_error("Failed to mutate");
+        }
+    }
+
+    //! Children \a child and \a child + 1 of \a parent1 and \a parent2, or copies of them
+    //! when settings.crossoverRate says they do not cross.
+    template<class PopulationType>
+    static void cross(PopulationType& population, const PopulationSettings& settings, const size_t parent1,
+                      const size_t parent2, typename PopulationType::Individuals& offspring, const size_t child)
+    {
+        //! Uncrossed children are copies, which keep their parents' fitness.
+        if (settings.crossoverRate < 1.0 && population.random().uniform() >= settings.crossoverRate) {
+            offspring.copyRow(child, population.individuals(), parent1);
+
+            if (child + 1 < offspring.size()) {
+                offspring.copyRow(child + 1, population.individuals(), parent2);
+            }
+        } else if (!population.crossover(settings.crossover, parent1, parent2, offspring, child)) {
+            throw std::runtime_error("Failed to crossover");
+        }
+    }
+
+    //! The fused pipeline, see PopulationSettings::fused: fills the offspring a pair at a
+    //! time, without a parents array, evaluating each child right after it is made
+    //! when \a evaluating.
+    template<class PopulationType, class FitnessFunc>
+    static void breed(PopulationType& population, const PopulationSettings& settings, const FitnessFunc& func,
+                      const bool evaluating)
+    {
+        if (!population.prepareSelection(settings.selection, settings.sampling)) {
+            throw std::runtime_error("Failed to select");
+        }
+
+        auto& offspring = population.offspring();
+
+        for (size_t i = 0; i < offspring.size(); i += 2) {
+            const auto parent1 = population.drawParent();
+            const auto parent2 = population.drawParent();
+            const auto end = std::min(i + 2, offspring.size());
+
+            cross(population, settings, parent1, parent2, offspring, i);
+            mutate(population, offspring, settings, i, end);
+
+            if constexpr (!FitnessEvaluator::IsBatch<FitnessFunc>) {
+                if (evaluating) {
+                    for (auto child = i; child < end; ++child) {
+                        population.updateFitness(offspring, child, func);
+                    }
+                }
+            }
+        }
+    }
+
+    //! Scratch of the memetic stage, kept for a whole run: per worker, a row to move
+    //! search points onto the encoding through and the search's own buffers; per elite,
+    //! the improved row and the calls it took.
+    template<class Individuals>
+    struct Memetic
+    {
+        std::vector<Individuals> rows;
+        std::vector<std::vector<double>> points;
+        std::vector<LocalSearch::Scratch> scratch;
+        std::vector<Individuals> improved;
+        std::vector<uint64_t> evaluations;
+        Selection::Parents elites;
+    };
+
+    //! The memetic stage, see PopulationSettings::localSearch. Each elite searches with
+    //! a stream of its own, drawn from the population's, so results do not depend on
+    //! the thread count. Only rows whose fitness came from \a func are searched.
+    template<class PopulationType, class FitnessFunc, class Individuals>
+    static void improve(PopulationType& population, const PopulationSettings& settings, const FitnessFunc& func,
+                        ThreadPool& pool, Memetic<Individuals>& memetic)
+    {
+        const auto& individuals = population.individuals();
+        const auto& bounds = population.bounds();
+        const auto count = std::min<size_t>(settings.localSearch.elites, individuals.size());
+
+        if (memetic.rows.size() != pool.size() || memetic.improved.size() != count) {
+            memetic.rows.assign(pool.size(), individuals.withSize(1));
+            memetic.points.assign(pool.size(), std::vector<double>(individuals.dimentions()));
+            memetic.scratch.assign(pool.size(), {});
+            memetic.improved.assign(count, individuals.withSize(1));
+            memetic.evaluations.assign(count, 0);
+        }
 
-        double bestFitness = std::numeric_limits<double>::max();
-        Individual bestInd;
+        Selection::fittest(individuals.fitnesses(), count, memetic.elites);
+        const auto seed = population.random().next64();
 
-        for (uint8_t epoch = 0; epoch < m_epochs; epoch++) {
-            std::cout << "Epoch: " << size_t(epoch) + 1 << std::endl;
-            std::cout << "----------------------------------" << std::endl;
-            population.updateFitness(func);
+        pool.parallelFor(count, 1, [&](const size_t begin, const size_t end, const size_t worker) {
+            auto& row = memetic.rows[worker];
+            auto& point = memetic.points[worker];
 
-            const auto minFitnessPred = [](const auto& ind, const auto& other) -> bool {
-                return ind.fitness() < other.fitness();
+            const auto evaluate = [&](std::span<double> genes) {
+                FitnessEvaluator::encode(row, 0, genes, bounds);
+                FitnessEvaluator::decode(row, 0, genes, bounds);
+                return FitnessEvaluator::evaluate(func, genes);
             };
 
-            const auto minFitness = *std::ranges::min_element(population.individuals(), minFitnessPred);
+            for (auto i = begin; i < end; ++i) {
+                const auto ix = memetic.elites[i];
+                memetic.evaluations[i] = 0;
+
+                if (individuals.dirty(ix)) {
+                    continue;
+                }
+
+                auto fitness = individuals.fitness(ix);
+                Random random(seed, i);
+
+                FitnessEvaluator::decode(individuals, ix, point, bounds);
+                memetic.evaluations[i] =
+                    LocalSearch::improve(settings.localSearch, point, fitness, bounds, random, memetic.scratch[worker], evaluate);
+
+                auto& improved = memetic.improved[i];
+                improved.setDirty(0, fitness >= individuals.fitness(ix));
+
+                if (!improved.dirty(0)) {
+                    FitnessEvaluator::encode(improved, 0, point, bounds);
+                    improved.setFitness(0, fitness);
+                }
+            }
+        });
+
+        for (size_t i = 0; i < count; ++i) {
+            population.countEvaluations(memetic.evaluations[i]);
+
+            if (memetic.evaluations[i] > 0 && !memetic.improved[i].dirty(0)) {
+                population.adopt(memetic.elites[i], memetic.improved[i], 0);
+            }
+        }
+    }
+
+    //! Whether a Termination criterion other than the target holds after an epoch.
+    bool terminated(const EpochStats& stats, const uint64_t stalled, const uint64_t evaluations,
+                    const Clock::time_point start) const
+    {
+        const auto& t = m_termination;
+
+        return (t.stallEpochs > 0 && stalled >= t.stallEpochs)
+               || (t.minDiversity > 0.0 && stats.diversity < t.minDiversity)
+               || (t.maxEvaluations > 0 && evaluations >= t.maxEvaluations)
+               || (t.maxSeconds > 0.0 && std::chrono::duration<double>(Clock::now() - start).count() >= t.maxSeconds)
+               || (t.stop && t.stop(stats));
+    }
+
+    static constexpr auto noExchange = [](const Snapshot::Progress&, const auto&) { return true; };
+
+    //! run()'s exchange: a snapshot every m_checkpointInterval epochs.
+    template<class PopulationType>
+    auto checkpointer(PopulationType& population)
+    {
+        return [this, &population](const Snapshot::Progress& progress, const auto& best) {
+            if (m_checkpoint && (progress.epoch + 1) % m_checkpointInterval == 0 && m_checkpoint->ready()) {
+                Snapshot::save(population.individuals(), best, population.random(), population.bounds(), progress,
+                               m_checkpoint->buffer());
+                m_checkpoint->commit();
+            }
+
+            return true;
+        };
+    }
+
+    //! Waits for the last checkpoint of a run, so it is complete once the run returns.
+    template<class Result>
+    Result finish(Result&& result)
+    {
+        if (m_checkpoint) {
+            m_checkpoint->wait();
+        }
+
+        return std::forward<Result>(result);
+    }
+
+    template<class PopulationType, class FitnessFunc>
+    auto restore(PopulationType& population, typename PopulationType::Individuals&& individuals,
+                 const PopulationSettings& settings, const std::string& path, FitnessFunc func, const double target)
+    {
+        auto best = individuals.withSize(1);
+        Snapshot::Progress progress;
+
+        {
+            MappedFile file(path);
+            population.random() = Snapshot::restore(file.bytes(), individuals, best, settings.bounds, progress);
+        }
+
+        population.setIndividuals(std::move(individuals));
+        population.countEvaluations(progress.evaluations);
+        configure(population, settings);
+
+        return finish(evolve(population, settings, func, target, threadPool(settings.threads), 0, checkpointer(population),
+                             &best, progress));
+    }
+
+    //! The generational loop, shared by Population and BasicPopulation. exchange(progress,
+    //! best) runs once the epoch's fitness is known and before selection, returning
+    //! false stops the run. A resumed run starts from \a resumed, its best individual
+    //! so far, and \a from, the progress saved with it. Every epoch is reported to the
+    //! telemetry, the run being the population's random stream.
+    template<class PopulationType, class FitnessFunc, class Exchange>
+    auto evolve(PopulationType& population, const PopulationSettings& settings, FitnessFunc func, const double target,
+                ThreadPool& pool, const uint32_t island, Exchange exchange,
+                const typename PopulationType::Individuals* resumed = nullptr, const Snapshot::Progress& from = {})
+    {
+        const bool tracing = m_telemetry->enabled();
+        const bool summarizing = tracing || bool(m_termination.stop);
+        const bool measuringDiversity = summarizing || m_termination.minDiversity > 0.0 || settings.adaptiveRates;
+        const auto start = Clock::now();
+
+        EpochStats stats{.run = population.random().stream(), .island = island};
+        std::vector<double> diversityScratch;
+        Rates rates{.mutation = from.mutationScale, .crossover = from.crossoverScale};
+        auto current = settings;
+
+        auto best = resumed ? *resumed : population.individuals().withSize(1);
+        double bestFitness = resumed ? best.fitness(0) : std::numeric_limits<double>::max();
+        double stallBest = resumed ? from.stallBest : bestFitness;
+        uint64_t stallSince = from.stallSince;
+        typename PopulationType::Parents parents;
+        Memetic<typename PopulationType::Individuals> memetic;
 
-            std::cout << "min fitness per epoch: " << minFitness.fitness() << std::endl;
+        using Result = decltype(best.individual(0));
 
-            if (minFitness.fitness() < bestFitness) {
-                bestFitness = minFitness.fitness();
-                bestInd = minFitness;
+        //! Fused runs evaluate children while breeding, so the counters are per epoch
+        //! from one summary to the next rather than around updateFitness().
+        const bool evaluatingAhead = settings.fused && pool.size() == 1 && settings.surrogateFraction >= 1.0;
+        auto evaluations = population.evaluator().evaluations();
+        auto cacheHits = population.evaluator().cacheHits();
+        auto predictions = population.evaluator().predictions();
+
+        for (auto epoch = std::min(from.epoch, m_epochs); epoch < m_epochs; epoch++) {
+            const auto allocations = AllocationCounter::allocations();
+            auto since = tracing ? Clock::now() : Clock::time_point{};
+
+            //! The snapshot was taken after this stage, so a restored generation is already
+            //! evaluated and improved; running it again would spend evaluations and random
+            //! draws the uninterrupted run never made.
+            if (!resumed || epoch != from.epoch) {
+                population.updateFitness(func, pool);
+
+                if (settings.localSearch.method != LocalSearch::Method::None) {
+                    improve(population, settings, func, pool, memetic);
+                }
+            }
+
+            stats.evaluateNs = lap(tracing, since);
+
+            const auto minIx = population.best();
+            const auto minFitness = population.individuals().fitness(minIx);
+
+            if (minFitness < bestFitness) {
+                bestFitness = minFitness;
+                best.copyRow(0, population.individuals(), minIx);
+            }
+
+            if (bestFitness < stallBest - m_termination.stallTolerance) {
+                stallBest = bestFitness;
+                stallSince = epoch;
+            }
+
+            stats.epoch = epoch;
+            stats.diversity = measuringDiversity
+                                  ? Statistics::diversity(population.individuals(), population.bounds(), diversityScratch)
+                                  : 0.0;
+
+            if (summarizing) {
+                const auto summary = Statistics::summarize(population.individuals().fitnesses());
+
+                stats.best = summary.best;
+                stats.mean = summary.mean;
+                stats.stddev = summary.stddev;
+                stats.evaluations = population.evaluator().evaluations() - evaluations;
+                stats.cacheHits = population.evaluator().cacheHits() - cacheHits;
+                stats.predictions = population.evaluator().predictions() - predictions;
+                evaluations = population.evaluator().evaluations();
+                cacheHits = population.evaluator().cacheHits();
+                predictions = population.evaluator().predictions();
+                stats.selectNs = stats.crossoverNs = stats.mutateNs = 0.0;
+                lap(tracing, since);
+            }
+
+            if (bestFitness <= target || terminated(stats, epoch - stallSince, population.evaluator().evaluations(), start)
+                || !exchange(Snapshot::Progress{.epoch = epoch,
+                                                .evaluations = population.evaluator().evaluations(),
+                                                .stallBest = stallBest,
+                                                .stallSince = stallSince,
+                                                .mutationScale = rates.mutation,
+                                                .crossoverScale = rates.crossover},
+                             best)) {
+                if (tracing) {
+                    stats.allocations = AllocationCounter::allocations() - allocations;
+                    m_telemetry->epoch(stats);
+                }
+
+                break;
+            }
+
+            if (settings.adaptiveRates) {
+                rates.adapt(stats.diversity, settings.targetDiversity);
+                current = rates.apply(settings);
+            }
+
+            if (settings.fused) {
+                //! The last epoch's children are never looked at, so not worth evaluating.
+                breed(population, current, func, evaluatingAhead && epoch + 1 < m_epochs);
+                stats.crossoverNs = lap(tracing, since);
+            } else {
+                if (!population.selection(settings.selection, parents, settings.sampling)) {
+                    throw std::runtime_error("Failed to select");
+                }
+
+                stats.selectNs = lap(tracing, since);
+
+                auto& offspring = population.offspring();
+
+                for (size_t i = 0; i < parents.size(); i += 2) {
+                    cross(population, current, parents[i], parents[(i + 1) % parents.size()], offspring, i);
+                }
+
+                stats.crossoverNs = lap(tracing, since);
+
+                mutate(population, offspring, current);
+                stats.mutateNs = lap(tracing, since);
+            }
+
+            population.swapGenerations();
+
+            if (tracing) {
+                stats.allocations = AllocationCounter::allocations() - allocations;
+                m_telemetry->epoch(stats);
+            }
+        }
+
+        return bestFitness < std::numeric_limits<double>::max() ? best.individual(0) : Result{};
+    }
+
+    template<class PopulationType, class FitnessFunc>
+    auto evolveIslands(std::vector<PopulationType>& populations, const PopulationSettings& settings,
+                       const IslandSettings& islands, FitnessFunc func, const double target)
+    {
+        using Result = decltype(populations.front().individuals().individual(0));
+
+        if (populations.empty()) {
+            throw std::runtime_error("No islands to evolve");
+        }
+
+        Migration<typename PopulationType::Individuals> migration(populations.size(), islands.topology,
+                                                                  populations.front().individuals(), islands.migrants);
+        std::vector<Result> results(populations.size());
+        std::atomic<bool> done = false;
+
+        threadPool(populations.size()).parallelFor(populations.size(), 1, [&](const size_t begin, const size_t end, size_t) {
+            ThreadPool serial(1);
+
+            for (size_t island = begin; island < end; ++island) {
+                auto& population = populations[island];
+
+                const auto exchange = [&](const Snapshot::Progress& progress, const auto&) {
+                    migration.receive(island, population);
+
+                    if (islands.interval > 0 && (progress.epoch + 1) % islands.interval == 0) {
+                        migration.send(island, population);
+                    }
+
+                    return !done.load(std::memory_order_relaxed);
+                };
+
+                results[island] = evolve(population, settings, func, target, serial, static_cast<uint32_t>(island), exchange);
+
+                if (results[island].fitness() <= target) {
+                    done.store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        return *std::ranges::min_element(results, {}, [](const auto& result) { return result.fitness(); });
+    }
+
+    //! makePopulation(run) builds the population of a run. Every run owns its population,
+    //! random stream and result slot; only the telemetry is shared.
+    template<class FitnessFunc, class MakePopulation>
+    auto evolveBatch(const PopulationSettings& settings, const BatchSettings& batch, FitnessFunc func,
+                     const double target, MakePopulation makePopulation)
+    {
+        using Result = decltype(makePopulation(0).individuals().individual(0));
+
+        BatchResult<Result> result;
+        result.runs.resize(batch.runs);
+
+        const auto firstRun = m_runs;
+        m_runs += batch.runs;
+
+        const auto threads = batch.threads > 0 ? batch.threads : std::max(std::thread::hardware_concurrency(), 1u);
+
+        threadPool(threads).parallelFor(batch.runs, 1, [&](const size_t begin, const size_t end, size_t) {
+            ThreadPool serial(1);
+
+            for (size_t i = begin; i < end; ++i) {
+                const auto start = Clock::now();
+                auto population = makePopulation(firstRun + i);
+                auto& run = result.runs[i];
+
+                run.best = evolve(population, settings, func, target, serial, 0, noExchange);
+                run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                run.evaluations = population.evaluator().evaluations();
+                run.reachedTarget = run.best.fitness() <= target;
+            }
+        });
+
+        if (result.runs.empty()) {
+            return result;
+        }
+
+        std::vector<double> fitness;
+        std::vector<double> evaluations;
+        std::vector<double> seconds;
+
+        for (const auto& run : result.runs) {
+            fitness.push_back(run.best.fitness());
+
+            if (run.reachedTarget) {
+                evaluations.push_back(static_cast<double>(run.evaluations));
+                seconds.push_back(run.seconds);
+            }
+        }
+
+        result.best = std::ranges::min_element(result.runs, {}, [](const auto& run) { return run.best.fitness(); })->best;
+        result.fitness = Statistics::quantiles(fitness);
+        result.reachedTarget = static_cast<uint32_t>(evaluations.size());
+        result.evaluationsToTarget = Statistics::quantiles(evaluations);
+        result.secondsToTarget = Statistics::quantiles(seconds);
+
+        return result;
+    }
+
+    template<class PopulationType, class FitnessFunc>
+    auto steadyState(PopulationType& population, const PopulationSettings& settings, FitnessFunc func, const double target)
+    {
+        using Individuals = typename PopulationType::Individuals;
+
+        auto& pool = threadPool(settings.threads);
+        population.updateFitness(func, pool);
+
+        auto best = population.individuals().withSize(1);
+        best.copyRow(0, population.individuals(), population.best());
+
+        const bool tracing = m_telemetry->enabled();
+        const auto start = Clock::now();
+        const uint64_t epochBudget = m_epochs > std::numeric_limits<uint64_t>::max() / std::max<uint64_t>(settings.size, 1)
+                                         ? std::numeric_limits<uint64_t>::max()
+                                         : uint64_t{settings.size} * m_epochs;
+        const uint64_t budget = m_termination.maxEvaluations > 0 ? std::min(epochBudget, m_termination.maxEvaluations)
+                                                                 : epochBudget;
+        const uint64_t window = std::max<uint64_t>(settings.size, 1);
+        std::vector<double> diversityScratch;
+        EpochStats stats{.run = population.random().stream()};
+
+        //! Everything below is shared between the workers and guarded by mutex, except
+        //! each worker's own children and evaluator.
+        std::mutex mutex;
+        typename PopulationType::Parents parents;
+        size_t cursor = 0;
+        uint64_t evaluations = 0;
+        uint64_t reported = 0;
+        bool done = best.fitness(0) <= target;
+
+        std::vector<Individuals> children(pool.size(), population.individuals().withSize(2));
+        std::vector<FitnessEvaluator> evaluators(pool.size());
+
+        const auto report = [&]() {
+            const auto summary = Statistics::summarize(population.individuals().fitnesses());
+
+            stats.epoch = reported++;
+            stats.best = summary.best;
+            stats.mean = summary.mean;
+            stats.stddev = summary.stddev;
+            stats.diversity = Statistics::diversity(population.individuals(), population.bounds(), diversityScratch);
+            stats.evaluations = window;
+            m_telemetry->epoch(stats);
+
+            stats.evaluateNs = stats.selectNs = stats.crossoverNs = stats.mutateNs = 0.0;
+        };
+
+        pool.parallelFor(pool.size(), 1, [&](size_t, size_t, const size_t worker) {
+            auto& pair = children[worker];
+            auto& evaluator = evaluators[worker];
+
+            while (true) {
+                {
+                    std::lock_guard lock(mutex);
+
+                    if (done || evaluations >= budget
+                        || (m_termination.maxSeconds > 0.0
+                            && std::chrono::duration<double>(Clock::now() - start).count() >= m_termination.maxSeconds)) {
+                        return;
+                    }
+
+                    auto since = tracing ? Clock::now() : Clock::time_point{};
+
+                    if (cursor + 1 >= parents.size()) {
+                        if (!population.selection(settings.selection, parents, settings.sampling)) {
+                            throw std::runtime_error("Failed to select");
+                        }
+
+                        cursor = 0;
+                        stats.selectNs += lap(tracing, since);
+                    }
+
+                    if (!population.crossover(settings.crossover, parents[cursor], parents[cursor + 1], pair, 0)) {
+                        throw std::runtime_error("Failed to crossover");
+                    }
+
+                    cursor += 2;
+                    stats.crossoverNs += lap(tracing, since);
+
+                    mutate(population, pair, settings);
+                    stats.mutateNs += lap(tracing, since);
+                }
+
+                const bool fresh[] = {pair.dirty(0), pair.dirty(1)};
+                auto since = tracing ? Clock::now() : Clock::time_point{};
+
+                evaluator.update(pair, func, population.bounds());
+
+                const auto evaluateNs = lap(tracing, since);
+
+                std::lock_guard lock(mutex);
+                stats.evaluateNs += evaluateNs;
+
+                for (size_t i = 0; i < 2; ++i) {
+                    if (!fresh[i]) {
+                        continue;
+                    }
+
+                    ++evaluations;
+
+                    if (population.replace(settings.replacement, pair, i) && pair.fitness(i) < best.fitness(0)) {
+                        best.copyRow(0, pair, i);
+                    }
+
+                    if (tracing && evaluations % window == 0) {
+                        report();
+                    }
+                }
+
+                done = done || best.fitness(0) <= target;
+            }
+        });
+
+        return best.individual(0);
+    }
+
+    //! The NSGA-II loop behind runPareto(). Objective rows live next to the population:
+    //! the current generation's in the first half of values, the offspring's in the
+    //! second. The next generation is assembled in the offspring buffer, surviving
+    //! parents taking the places of the children that did not make it.
+    template<class PopulationType, class ObjectiveFunc>
+    auto pareto(PopulationType& population, const PopulationSettings& settings, const uint32_t objectives,
+                ObjectiveFunc func, ThreadPool& pool)
+    {
+        using Result = ParetoArchive<decltype(population.individuals().individual(0))>;
+
+        if (objectives == 0) {
+            throw std::runtime_error("No objectives");
+        }
+
+        const bool tracing = m_telemetry->enabled();
+        const bool measuringDiversity = tracing || m_termination.minDiversity > 0.0 || bool(m_termination.stop);
+        const auto start = Clock::now();
+        const auto size = population.size();
+        const size_t width = objectives;
+
+        EpochStats stats{.run = population.random().stream()};
+        std::vector<double> values(2 * size * width);
+        std::vector<uint32_t> fronts, survivors, parentFronts;
+        std::vector<double> crowding, parentCrowding, diversityScratch, firstObjective;
+        std::vector<std::vector<double>> decoded(pool.size());
+        std::vector<uint8_t> kept;
+        Pareto::Scratch scratch;
+        typename PopulationType::Parents parents;
+        uint64_t evaluations = 0;
+
+        const auto row = [&](const size_t ix) { return std::span<double>(values).subspan(ix * width, width); };
+        const auto evaluate = [&]() {
+            auto& offspring = population.offspring();
+            const auto grain = std::max<size_t>(1, size / (pool.size() * 8));
+
+            pool.parallelFor(size, grain, [&](const size_t begin, const size_t end, const size_t worker) {
+                auto& genes = decoded[worker];
+                genes.resize(offspring.dimentions());
+
+                for (auto i = begin; i < end; ++i) {
+                    if (offspring.dirty(i)) {
+                        FitnessEvaluator::decode(offspring, i, genes, population.bounds());
+                        func(std::span<const double>(genes), row(size + i));
+                    }
+                }
+            });
+
+            for (size_t i = 0; i < size; ++i) {
+                if (offspring.dirty(i)) {
+                    offspring.setDirty(i, false);
+                    ++evaluations;
+                }
             }
+        };
+        //! Makes the offspring buffer current, its rows ranked by parentFronts.
+        const auto advance = [&]() {
+            auto& offspring = population.offspring();
 
-            if (bestFitness <= target) {
-                return std::move(bestInd);
+            for (size_t i = 0; i < size; ++i) {
+                offspring.setFitness(i, parentFronts[i]);
             }
 
-            const auto selected = population.selection(settings.selection);
+            population.swapGenerations();
+            std::copy(values.begin() + size * width, values.end(), values.begin());
+        };
+
+        //! The first generation is evaluated as its own offspring.
+        for (size_t i = 0; i < size; ++i) {
+            population.offspring().copyRow(i, population.individuals(), i);
+        }
+
+        evaluate();
+        Pareto::select(std::span<const double>(values).subspan(size * width), width, size, survivors, parentFronts,
+                       parentCrowding, scratch);
+        advance();
 
-            if (!selected) {
-                throw std::runtime_error("Failed to select");
+        auto reported = uint64_t{0};
+
+        for (uint64_t epoch = 0; epoch < m_epochs; ++epoch) {
+            const auto allocations = AllocationCounter::allocations();
+
+            stats.epoch = epoch;
+            stats.evaluations = evaluations - reported;
+            stats.evaluateNs = stats.selectNs = stats.crossoverNs = stats.mutateNs = 0.0;
+            reported = evaluations;
+            stats.diversity = measuringDiversity
+                                  ? Statistics::diversity(population.individuals(), population.bounds(), diversityScratch)
+                                  : 0.0;
+
+            if (tracing) {
+                firstObjective.resize(size);
+
+                for (size_t i = 0; i < size; ++i) {
+                    firstObjective[i] = values[i * width];
+                }
+
+                const auto summary = Statistics::summarize(firstObjective);
+                stats.best = summary.best;
+                stats.mean = summary.mean;
+                stats.stddev = summary.stddev;
+            }
+
+            const auto report = [&]() {
+                if (tracing) {
+                    stats.allocations = AllocationCounter::allocations() - allocations;
+                    m_telemetry->epoch(stats);
+                }
+            };
+
+            if (terminated(stats, 0, evaluations, start)) {
+                report();
+                break;
             }
 
-            const auto& selectedVal = selected.value();
+            auto since = tracing ? Clock::now() : Clock::time_point{};
 
-            Population::Individuals newInds;
-            newInds.reserve(selected->size());
+            Pareto::tournament(parentFronts, parentCrowding, population.random(), parents, size);
+            stats.selectNs = lap(tracing, since);
 
-            for (size_t i = 0; i < selected->size(); i += 2) {
-                const auto& parent1 = selectedVal[i];
-                const auto& parent2 = selectedVal[(i + 1) % selectedVal.size()];
+            auto& offspring = population.offspring();
+            const auto& current = population.individuals();
+            //! Children identical to a parent are not evaluated again, they take its objectives.
+            const auto inherit = [&](const size_t child, const uint32_t parent1, const uint32_t parent2) {
+                if (child < size && !offspring.dirty(child)) {
+                    const auto parent = offspring.sameRow(child, current, parent1) ? parent1 : parent2;
+                    std::ranges::copy(row(parent), row(size + child).begin());
+                }
+            };
 
-                const auto res = population.crossover(settings.crossover, parent1, parent2);
+            for (size_t i = 0; i < size; i += 2) {
+                const auto parent1 = parents[i];
+                const auto parent2 = parents[(i + 1) % size];
 
-                if (!res) {
+                if (settings.crossoverRate < 1.0 && population.random().uniform() >= settings.crossoverRate) {
+                    offspring.copyRow(i, current, parent1);
+
+                    if (i + 1 < size) {
+                        offspring.copyRow(i + 1, current, parent2);
+                    }
+                } else if (!population.crossover(settings.crossover, parent1, parent2, offspring, i)) {
                     throw std::runtime_error("Failed to crossover");
                 }
 
-                auto [child1, child2] = res.value();
-                child1.mutate(settings.mutationChance, settings.bounds);
-                child2.mutate(settings.mutationChance, settings.bounds);
-                newInds.push_back(child1);
-                newInds.push_back(child2);
+                inherit(i, parent1, parent2);
+                inherit(i + 1, parent1, parent2);
             }
 
-            population.setIndividuals(newInds);
+            stats.crossoverNs = lap(tracing, since);
+
+            mutate(population, offspring, settings);
+            stats.mutateNs = lap(tracing, since);
+
+            evaluate();
+            stats.evaluateNs = lap(tracing, since);
+
+            Pareto::select(values, width, size, survivors, fronts, crowding, scratch);
+
+            //! Surviving children stay where they are, surviving parents fill the gaps.
+            kept.assign(size, 0);
+
+            for (const auto survivor : survivors) {
+                if (survivor >= size) {
+                    kept[survivor - size] = 1;
+                    parentFronts[survivor - size] = fronts[survivor];
+                    parentCrowding[survivor - size] = crowding[survivor];
+                }
+            }
+
+            size_t slot = 0;
+
+            for (const auto survivor : survivors) {
+                if (survivor < size) {
+                    while (kept[slot]) {
+                        ++slot;
+                    }
+
+                    offspring.copyRow(slot, current, survivor);
+                    std::ranges::copy(row(survivor), row(size + slot).begin());
+                    parentFronts[slot] = fronts[survivor];
+                    parentCrowding[slot] = crowding[survivor];
+                    kept[slot] = 1;
+                }
+            }
+
+            advance();
+            stats.selectNs += lap(tracing, since);
+            report();
         }
 
-        return bestInd;
+        //! The first front, duplicates dropped.
+        Result result;
+        result.objectives = objectives;
+
+        const auto& individuals = population.individuals();
+        auto& order = parents;
+        order.clear();
+
+        for (uint32_t i = 0; i < size; ++i) {
+            if (parentFronts[i] == 0) {
+                order.push_back(i);
+            }
+        }
+
+        std::ranges::sort(order, [&](const auto a, const auto b) {
+            const auto rowA = row(a);
+            const auto rowB = row(b);
+            return std::ranges::lexicographical_compare(rowA, rowB)
+                   || (std::ranges::equal(rowA, rowB)
+                       && std::ranges::lexicographical_compare(individuals.rowBytes(a), individuals.rowBytes(b)));
+        });
+
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (i > 0 && individuals.sameRow(order[i], individuals, order[i - 1])) {
+                continue;
+            }
+
+            result.individuals.push_back(individuals.individual(order[i]));
+            result.values.insert(result.values.end(), row(order[i]).begin(), row(order[i]).end());
+        }
+
+        return result;
     }
 
-private:
-    uint8_t m_epochs;
+    //! The pool outlives a single run, it is only rebuilt when the thread count changes.
+    ThreadPool& threadPool(const uint32_t threads);
+
+    uint64_t m_epochs;
+    uint64_t m_runs = 0;
+    Telemetry* m_telemetry = &Telemetry::none();
+    Termination m_termination;
+    std::unique_ptr<SnapshotWriter> m_checkpoint;
+    uint32_t m_checkpointInterval = 0;
+    std::unique_ptr<ThreadPool> m_pool;
 };
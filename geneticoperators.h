@@ -0,0 +1,423 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+#include "random.h"
+
+//! Crossover, mutation and decode kernels shared by Population and BasicPopulation.
+//! They are templated on the span extent: with a compile time dimension the loops
+//! have a constant trip count the compiler can unroll and vectorize. The second
+//! child may be an empty (dynamic extent) span, it is skipped then. Long rows are
+//! worked through BlockGenes genes at a time, so every pass over a block finds it
+//! in L1 whatever the dimension.
+class GeneticOperators final
+{
+public:
+    using Bounds = std::pair<double, double>;
+    //! Packed Gray genomes are stored in 64-bit words.
+    using Code = uint64_t;
+
+    //! 8 KB of doubles: two parent and two child blocks fit in a 32 KB L1 together.
+    static constexpr size_t BlockGenes = 1024;
+
+    //! Per-gene mutation of the sparse pass: real genes are reset uniformly within the
+    //! bounds, moved by a Gaussian step or by a polynomial one; Gray genomes flip bits.
+    enum class Mutation
+    {
+        None = 0,
+        Uniform,
+        Gaussian,
+        Polynomial,
+        BitFlip
+    };
+
+    template<size_t Extent, size_t ChildExtent>
+    static void discreteCrossover(std::span<const double, Extent> parent1, std::span<const double, Extent> parent2,
+                                  std::span<double, Extent> child1, std::span<double, ChildExtent> child2, Random& random)
+    {
+        assert(parent1.size() == parent2.size());
+        std::array<uint32_t, BlockGenes / 32> coins;
+
+        for (size_t begin = 0; begin < parent1.size(); begin += BlockGenes) {
+            const auto count = std::min(BlockGenes, parent1.size() - begin);
+
+            //! One 32-bit draw covers 32 genes, drawn up front so the loops below are branch free.
+            for (size_t w = 0; w < (count + 31) / 32; ++w) {
+                coins[w] = random();
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                const bool keep = (coins[i / 32] >> (i % 32)) & 1u;
+                child1[begin + i] = keep ? parent1[begin + i] : parent2[begin + i];
+            }
+
+            if (!child2.empty()) {
+                for (size_t i = 0; i < count; ++i) {
+                    const bool keep = (coins[i / 32] >> (i % 32)) & 1u;
+                    child2[begin + i] = keep ? parent2[begin + i] : parent1[begin + i];
+                }
+            }
+        }
+    }
+
+    template<size_t Extent, size_t ChildExtent>
+    static void linearCrossover(std::span<const double, Extent> parent1, std::span<const double, Extent> parent2,
+                                std::span<double, Extent> child1, std::span<double, ChildExtent> child2)
+    {
+        const auto alpha = 0.5;
+
+        for (size_t begin = 0; begin < parent1.size(); begin += BlockGenes) {
+            const auto end = std::min(parent1.size(), begin + BlockGenes);
+
+            for (size_t i = begin; i < end; ++i) {
+                child1[i] = (alpha * parent1[i]) + ((1 - alpha) * parent2[i]);
+            }
+
+            //! The parents' block is still in L1 for the second child.
+            if (!child2.empty()) {
+                for (size_t i = begin; i < end; ++i) {
+                    child2[i] = ((1 - alpha) * parent2[i]) + (alpha * parent1[i]);
+                }
+            }
+        }
+    }
+
+    //! Classic two-point crossover over the whole packed bit string: the bits between two
+    //! random cut points come from the other parent. Only the two words holding the cut
+    //! points need masks, the runs of whole words around them are plain copies.
+    template<size_t Extent, size_t ChildExtent>
+    static void twoPointCrossover(std::span<const Code, Extent> parent1, std::span<const Code, Extent> parent2,
+                                  std::span<Code, Extent> child1, std::span<Code, ChildExtent> child2,
+                                  const size_t totalBits, Random& random)
+    {
+        auto point1 = random.index(totalBits + 1);
+        auto point2 = random.index(totalBits + 1);
+
+        if (point1 > point2) {
+            std::swap(point1, point2);
+        }
+
+        const auto words = parent1.size();
+        const auto first = std::min<size_t>(point1 / WordBits, words);
+        const auto last = std::min<size_t>(point2 / WordBits, words);
+
+        const auto cross = [&](const size_t w) {
+            const auto low = w * WordBits;
+            const auto from = std::clamp<size_t>(point1, low, low + WordBits) - low;
+            const auto to = std::clamp<size_t>(point2, low, low + WordBits) - low;
+            const auto mask = lowMask(to) & ~lowMask(from);
+
+            child1[w] = (parent1[w] & ~mask) | (parent2[w] & mask);
+
+            if (!child2.empty()) {
+                child2[w] = (parent2[w] & ~mask) | (parent1[w] & mask);
+            }
+        };
+
+        const auto copy = [&](const size_t begin, const size_t end, const auto& from1, const auto& from2) {
+            std::copy(from1.begin() + begin, from1.begin() + end, child1.begin() + begin);
+
+            if (!child2.empty()) {
+                std::copy(from2.begin() + begin, from2.begin() + end, child2.begin() + begin);
+            }
+        };
+
+        copy(0, first, parent1, parent2);
+
+        if (first < words) {
+            cross(first);
+        }
+
+        if (last > first) {
+            copy(first + 1, last, parent2, parent1);
+
+            if (last < words) {
+                cross(last);
+            }
+        }
+
+        copy(std::min(last + 1, words), words, parent1, parent2);
+    }
+
+    //! Row \a child of \a children after a crossover of rows \a parent1 and \a parent2 of
+    //! \a parents: a copy of either parent takes its fitness and dirty flag, anything else
+    //! is marked dirty. Works on GenePool and BasicGenePool alike.
+    template<class Pool>
+    static void inherit(const Pool& parents, Pool& children, const size_t child, const size_t parent1,
+                        const size_t parent2)
+    {
+        for (const auto parent : {parent1, parent2}) {
+            if (children.sameRow(child, parents, parent)) {
+                children.setFitness(child, parents.fitness(parent));
+                children.setDirty(child, parents.dirty(parent));
+                return;
+            }
+        }
+
+        children.setDirty(child, true);
+    }
+
+    //! With \a probability, resets one random gene to a uniform value within \a bounds.
+    //! Returns whether it did.
+    template<size_t Extent>
+    static bool mutate(std::span<double, Extent> genes, Random& random, const double probability, const Bounds& bounds)
+    {
+        if (random.uniform() < probability) {
+            const auto ix = random.index(genes.size());
+            genes[ix] = random.uniform(bounds.first, bounds.second);
+            return true;
+        }
+
+        return false;
+    }
+
+    //! With \a probability, flips one random bit of a packed genome of \a totalBits bits.
+    //! Returns whether it did.
+    template<size_t Extent>
+    static bool flipMutate(std::span<Code, Extent> words, Random& random, const double probability, const size_t totalBits)
+    {
+        if (random.uniform() < probability) {
+            const auto bit = random.index(totalBits);
+            words[bit / WordBits] ^= Code{1} << (bit % WordBits);
+            return true;
+        }
+
+        return false;
+    }
+
+    //! Sparse mutation: calls visit(position) for each of \a trials independent
+    //! Bernoulli(\a rate) trials that succeed, in order. Gaps between successes are
+    //! drawn from the geometric distribution, so the cost is one draw per success
+    //! whatever the number of trials. Returns the number of successes.
+    template<class Visit>
+    static uint64_t sparseTrials(const uint64_t trials, const double rate, Random& random, Visit&& visit)
+    {
+        if (!(rate > 0.0)) {
+            return 0;
+        }
+
+        if (rate >= 1.0) {
+            for (uint64_t position = 0; position < trials; ++position) {
+                visit(position);
+            }
+
+            return trials;
+        }
+
+        const auto logFail = std::log1p(-rate);
+        uint64_t hits = 0;
+
+        for (auto position = geometricSkip(random, logFail); position < trials; ++hits) {
+            visit(position);
+
+            const auto skip = geometricSkip(random, logFail);
+
+            if (skip >= trials - position - 1) {
+                return hits + 1;
+            }
+
+            position += skip + 1;
+        }
+
+        return hits;
+    }
+
+    //! Sparse pass of \a type over \a rows rows of \a dimentions real genes, every gene
+    //! mutating independently with probability \a rate. Rows stored below double
+    //! precision have no span, so the genes are read with gene(row, at) and written with
+    //! setGene(row, at, value), row counting from 0; only mutated genes are written.
+    //! Fails for None and BitFlip.
+    template<class Get, class Set>
+    static bool sparseMutate(const Mutation type, const size_t rows, const size_t dimentions, const double rate,
+                             const Bounds& bounds, Random& random, const Get& gene, const Set& setGene)
+    {
+        if (type == Mutation::None || type == Mutation::BitFlip || dimentions == 0) {
+            return false;
+        }
+
+        sparseTrials(rows * dimentions, rate, random, [&](const uint64_t position) {
+            const auto row = position / dimentions;
+            const auto at = position % dimentions;
+
+            setGene(row, at, mutateGene(type, gene(row, at), random, bounds));
+        });
+
+        return true;
+    }
+
+    //! Sparse bit flips over \a rows packed Gray rows of \a rowBits bits, each bit flipping
+    //! with probability \a rate. codes(row) is the row's words, mutated(row) is called
+    //! after every flip.
+    template<class Codes, class Mutated>
+    static void sparseFlip(const size_t rows, const size_t rowBits, const double rate, Random& random,
+                           const Codes& codes, const Mutated& mutated)
+    {
+        sparseTrials(rows * rowBits, rate, random, [&](const uint64_t position) {
+            const auto row = position / rowBits;
+            const auto bit = position % rowBits;
+
+            codes(row)[bit / WordBits] ^= Code{1} << (bit % WordBits);
+            mutated(row);
+        });
+    }
+
+    //! \a value after a mutation of \a type, None and BitFlip leave it alone.
+    static double mutateGene(const Mutation type, const double value, Random& random, const Bounds& bounds)
+    {
+        switch (type) {
+        case Mutation::Uniform:
+            return random.uniform(bounds.first, bounds.second);
+        case Mutation::Gaussian:
+            return gaussianMutation(value, random, bounds);
+        case Mutation::Polynomial:
+            return polynomialMutation(value, random, bounds);
+        default:
+            return value;
+        }
+    }
+
+    //! Failures before the next success of Bernoulli trials that fail with log probability \a logFail.
+    static uint64_t geometricSkip(Random& random, const double logFail)
+    {
+        //! 1 - uniform() is in (0, 1], so the log is finite.
+        const auto skip = std::floor(std::log(1.0 - random.uniform()) / logFail);
+        return skip < 0x1p63 ? static_cast<uint64_t>(skip) : std::numeric_limits<uint64_t>::max();
+    }
+
+    //! Adds a normal step of GaussianSigma bounds widths, clamped to \a bounds.
+    static double gaussianMutation(const double value, Random& random, const Bounds& bounds)
+    {
+        const auto width = bounds.second - bounds.first;
+        return std::clamp(value + random.normal() * GaussianSigma * width, bounds.first, bounds.second);
+    }
+
+    //! Deb's bounded polynomial mutation with distribution index PolynomialEta: small
+    //! steps are likely, the step shrinks towards the nearer bound.
+    static double polynomialMutation(const double value, Random& random, const Bounds& bounds)
+    {
+        const auto width = bounds.second - bounds.first;
+
+        if (!(width > 0.0)) {
+            return value;
+        }
+
+        const auto u = random.uniform();
+        const auto power = 1.0 / (PolynomialEta + 1.0);
+        double step;
+
+        if (u < 0.5) {
+            const auto room = 1.0 - (value - bounds.first) / width;
+            const auto base = 2.0 * u + (1.0 - 2.0 * u) * std::pow(room, PolynomialEta + 1.0);
+            step = std::pow(base, power) - 1.0;
+        } else {
+            const auto room = 1.0 - (bounds.second - value) / width;
+            const auto base = 2.0 * (1.0 - u) + 2.0 * (u - 0.5) * std::pow(room, PolynomialEta + 1.0);
+            step = 1.0 - std::pow(base, power);
+        }
+
+        return std::clamp(value + step * width, bounds.first, bounds.second);
+    }
+
+    static constexpr double GaussianSigma = 0.1;
+    static constexpr double PolynomialEta = 20.0;
+
+    //! Packed Gray genomes: gene i takes bits [i * bits, (i + 1) * bits) of the row,
+    //! low bits first, and may straddle two words.
+    static constexpr size_t wordsFor(const size_t dimentions, const size_t bits)
+    {
+        return (dimentions * bits + WordBits - 1) / WordBits;
+    }
+
+    static constexpr Code lowMask(const size_t bits)
+    {
+        return bits >= WordBits ? ~Code{0} : (Code{1} << bits) - 1;
+    }
+
+    template<size_t Extent>
+    static Code extract(std::span<const Code, Extent> row, const size_t gene, const size_t bits)
+    {
+        const auto bit = gene * bits;
+        const auto word = bit / WordBits;
+        const auto offset = bit % WordBits;
+
+        auto value = row[word] >> offset;
+
+        if (offset + bits > WordBits) {
+            value |= row[word + 1] << (WordBits - offset);
+        }
+
+        return value & lowMask(bits);
+    }
+
+    template<size_t Extent>
+    static void insert(std::span<Code, Extent> row, const size_t gene, const size_t bits, Code value)
+    {
+        const auto bit = gene * bits;
+        const auto word = bit / WordBits;
+        const auto offset = bit % WordBits;
+        const auto mask = lowMask(bits);
+
+        value &= mask;
+        row[word] = (row[word] & ~(mask << offset)) | (value << offset);
+
+        if (offset + bits > WordBits) {
+            const auto spill = WordBits - offset;
+            row[word + 1] = (row[word + 1] & ~(mask >> spill)) | (value >> spill);
+        }
+    }
+
+    //! Prefix XOR from the top bit down, log2(64) shift/xor steps instead of one per bit.
+    static constexpr Code grayToBinary(Code gray)
+    {
+        for (size_t shift = 1; shift < WordBits; shift <<= 1) {
+            gray ^= gray >> shift;
+        }
+
+        return gray;
+    }
+
+    static constexpr Code binaryToGray(const Code binary)
+    {
+        return binary ^ (binary >> 1);
+    }
+
+    //! Maps a \a bits wide Gray code word back onto \a bounds.
+    static double decode(const Code code, const size_t bits, const Bounds& bounds)
+    {
+        const auto levels = static_cast<double>(lowMask(bits));
+        return bounds.first + grayToBinary(code) / levels * (bounds.second - bounds.first);
+    }
+
+    //! Decodes genes [firstGene, firstGene + out.size()) of a packed row, so a long row
+    //! can be decoded a block at a time.
+    template<size_t Extent, size_t OutExtent>
+    static void decode(std::span<const Code, Extent> row, const size_t bits, std::span<double, OutExtent> out, const Bounds& bounds,
+                       const size_t firstGene = 0)
+    {
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = decode(extract(row, firstGene + i, bits), bits, bounds);
+        }
+    }
+
+    //! \a bits wide Gray code word of a value within \a bounds.
+    static Code encode(const double value, const size_t bits, const Bounds& bounds)
+    {
+        const auto levels = static_cast<double>(lowMask(bits));
+        const auto unit = std::clamp((value - bounds.first) / (bounds.second - bounds.first), 0.0, 1.0);
+        const auto scaled = unit * levels + 0.5;
+
+        //! 2^64 - 1 rounds up to 2^64 as a double, which would overflow the conversion.
+        return binaryToGray(scaled >= 0x1p64 ? lowMask(bits) : static_cast<Code>(scaled));
+    }
+
+private:
+    static constexpr size_t WordBits = 64;
+};
@@ -1,38 +1,44 @@
 #include "individual.h"
+#include "geneticoperators.h"
 
-#include <random>
 #include <sstream>
 #include <iostream>
 
 
-Individual::Individual(const uint8_t dimentions, const Type type)
+Individual::Individual(const size_t dimentions, const Type type, const uint8_t bitsPerGene)
     : m_type{type}
+    , m_bitsPerGene{bitsPerGene}
 {
-    std::visit([&](auto&& chromosomes) {
-        chromosomes.reserve(dimentions);
-    }, m_chromoses);
-
     switch (type)  {
 
     case Type::None:
     case Type::Discrete:
         m_chromoses = Gene{};
+        break;
     case Type::GrayCode:
         m_chromoses = GrayCode{};
         break;
     }
+
+    std::visit([&](auto&& chromosomes) {
+        chromosomes.reserve(dimentions);
+    }, m_chromoses);
 }
 
 Individual::Individual(const Individual& other)
 {
     m_chromoses = other.m_chromoses;
     m_fitness = other.fitness();
+    m_type = other.m_type;
+    m_bitsPerGene = other.m_bitsPerGene;
 }
 
 Individual& Individual::operator=(const Individual& other)
 {
     m_chromoses = other.m_chromoses;
     m_fitness = other.fitness();
+    m_type = other.m_type;
+    m_bitsPerGene = other.m_bitsPerGene;
     return *this;
 }
 
@@ -40,6 +46,8 @@ Individual& Individual::operator=(Individual&& other)
 {
     m_chromoses = std::move(other.m_chromoses);
     m_fitness = other.fitness();
+    m_type = other.m_type;
+    m_bitsPerGene = other.m_bitsPerGene;
     return *this;
 }
 
@@ -47,6 +55,8 @@ Individual::Individual(Individual&& other)
 {
     m_chromoses = std::move(other.m_chromoses);
     m_fitness = other.fitness();
+    m_type = other.m_type;
+    m_bitsPerGene = other.m_bitsPerGene;
 }
 
 void Individual::append(const double val)
@@ -56,27 +66,26 @@ void Individual::append(const double val)
 
 void Individual::append(const std::bitset<8> bitset)
 {
-    std::get<GrayCode>(m_chromoses).push_back(bitset);
+    std::get<GrayCode>(m_chromoses).push_back(bitset.to_ullong());
 }
 
-void Individual::mutate(const double probability, const Bounds& bounds)
+void Individual::appendCode(const uint64_t code)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
+    std::get<GrayCode>(m_chromoses).push_back(code);
+}
 
+void Individual::mutate(Random& random, const double probability, const Bounds& bounds)
+{
     if (std::holds_alternative<Gene>(m_chromoses)) {
-        auto& chromosomes = std::get<Gene>(m_chromoses);
-
-        if (dis(gen) < probability) {
-            std::uniform_int_distribution<> intDis(0, chromosomes.size() - 1);
-            const auto ix = intDis(gen);
-            std::uniform_real_distribution<> boundsDis(bounds.first, bounds.second);
-            chromosomes[ix] = boundsDis(gen);
-        }
+        mutate(std::get<Gene>(m_chromoses), random, probability, bounds);
     }
 }
 
+void Individual::mutate(std::span<double> genes, Random& random, const double probability, const Bounds& bounds)
+{
+    GeneticOperators::mutate(genes, random, probability, bounds);
+}
+
 const Individual::Chromosomes& Individual::chromosomes() const
 {
     return m_chromoses;
@@ -108,7 +117,7 @@ std::string Individual::toString() const
         const auto& grayCode = std::get<GrayCode>(m_chromoses);
 
         for (size_t i = 0; i < grayCode.size(); ++i) {
-            ss << grayCode[i].to_string();
+            ss << std::bitset<64>(grayCode[i]).to_string().substr(64 - m_bitsPerGene);
 
             if (i < grayCode.size() - 1) {
                 ss << ", ";
@@ -131,11 +140,16 @@ double Individual::fitness() const
     return m_fitness;
 }
 
+uint8_t Individual::bitsPerGene() const
+{
+    return m_bitsPerGene;
+}
+
 size_t Individual::size() const
 {
     if (std::holds_alternative<Gene>(m_chromoses)) {
         return std::get<Gene>(m_chromoses).size();
     }
 
-    return 8;
+    return std::get<GrayCode>(m_chromoses).size();
 }
@@ -1,16 +1,21 @@
 #pragma once
 
+#include <span>
 #include <bitset>
 #include <string>
+#include <cstdint>
 #include <vector>
 #include <variant>
 
+#include "random.h"
+
 class Individual final
 {
 public:
     using Bounds = std::pair<double, double>;
     using Gene = std::vector<double>;
-    using GrayCode = std::vector<std::bitset<8>>;
+    //! One Gray code word per gene, bitsPerGene() bits wide.
+    using GrayCode = std::vector<uint64_t>;
     using Chromosomes = std::variant<Gene, GrayCode>;
 
     enum class Type
@@ -20,7 +25,7 @@ public:
         GrayCode
     };
 
-    Individual(const uint8_t dimentions = 1, const Type = Individual::Type::Discrete);
+    Individual(const size_t dimentions = 1, const Type = Individual::Type::Discrete, const uint8_t bitsPerGene = 8);
     Individual(const Individual&);
     Individual& operator=(const Individual&);
     Individual& operator=(Individual&&);
@@ -28,13 +33,18 @@ public:
 
     void append(const double val);
     void append(const std::bitset<8>);
+    void appendCode(const uint64_t code);
 
-    void mutate(const double probability, const Bounds& bounds = std::pair(-1.0, 1.0));
+    void mutate(Random& random, const double probability, const Bounds& bounds = std::pair(-1.0, 1.0));
+    //! Same as above, but works on a gene row owned by someone else (e.g. a GenePool).
+    static void mutate(std::span<double> genes, Random& random, const double probability,
+                       const Bounds& bounds = std::pair(-1.0, 1.0));
 
     void setFitness(const double val);
     double fitness() const;
 
     size_t size() const;
+    uint8_t bitsPerGene() const;
 
     const Chromosomes& chromosomes() const;
     void setChromosomes(const Chromosomes&);
@@ -45,4 +55,5 @@ private:
     double m_fitness = 0.0;
     Chromosomes m_chromoses;
     Type m_type;
+    uint8_t m_bitsPerGene = 8;
 };
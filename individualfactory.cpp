@@ -1,52 +1,67 @@
 #include "individualfactory.h"
 
-#include <bitset>
-#include <iostream>
-#include <random>
+#include <array>
 
 #include "individual.h"
+#include "geneticoperators.h"
 
 Individual IndividualFactory::create(const Population::IndividualType individualType,
-                                     const uint8_t dimentions, const Population::Bounds& bounds)
+                                     const size_t dimentions, const Population::Bounds& bounds, Random& random,
+                                     const uint8_t bitsPerGene, const Population::GenePrecision precision)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-
     switch (individualType) {
     case Population::IndividualType::None:
         break;
     case Population::IndividualType::Discrete: {
-        static std::uniform_real_distribution<double> dist(bounds.first, bounds.second);
-        Individual ind(dimentions);
-
-        for (uint8_t i = 0; i < dimentions; i++) {
-            ind.append(dist(gen));
-        }
-
-        return (std::move(ind));
+        GenePool pool(1, dimentions, Individual::Type::Discrete, bitsPerGene, std::pmr::get_default_resource(),
+                      precision, bounds);
+        create(pool, 0, bounds, random);
+        return pool.individual(0);
     }
     case Population::IndividualType::GrayCode: {
-        static std::uniform_real_distribution<double> dist(bounds.first, bounds.second);
-        const auto val = dist(gen);
-        const auto maxInt = (1 << 8) - 1;
-        const auto scaledValue = static_cast<uint8_t>(std::round(val / bounds.second * maxInt));
-
-        const auto getVal = [] (auto val) -> uint8_t {
-            val ^= (val >> 1);
-            return val;
-        };
+        GenePool pool(1, dimentions, Individual::Type::GrayCode, bitsPerGene);
+        create(pool.codes(0), dimentions, bitsPerGene, bounds, random);
+        return pool.individual(0);
+    }
+    }
 
-        std::cout << val << " " << std::bitset<8>(getVal(scaledValue)) << std::endl;
+    return Individual{};
+}
 
-        Individual ind(dimentions, Individual::Type::GrayCode);
+void IndividualFactory::create(std::span<double> genes, const Population::Bounds& bounds, Random& random)
+{
+    random.fill(genes);
 
-        for (uint8_t i = 0; i < dimentions; i++) {
-            ind.append(std::bitset<8>(getVal(scaledValue)));
-        }
+    for (auto& gene : genes) {
+        gene = bounds.first + gene * (bounds.second - bounds.first);
+    }
+}
 
-        return std::move(ind);
+void IndividualFactory::create(GenePool& pool, const size_t ix, const Population::Bounds& bounds, Random& random)
+{
+    if (pool.precision() == GenePool::Precision::Double) {
+        create(pool.genes(ix), bounds, random);
+        return;
     }
+
+    std::array<double, GeneticOperators::BlockGenes> block;
+
+    for (size_t begin = 0; begin < pool.dimentions(); begin += block.size()) {
+        const auto genes = std::span<double>(block).first(std::min(block.size(), pool.dimentions() - begin));
+        create(genes, bounds, random);
+        pool.store(ix, genes, begin);
     }
+}
 
-    return Individual{};
+void IndividualFactory::create(std::span<GenePool::Code> codes, const size_t dimentions, const uint8_t bitsPerGene,
+                               const Population::Bounds& bounds, Random& random)
+{
+    std::ranges::fill(codes, GenePool::Code{0});
+
+    for (size_t gene = 0; gene < dimentions; ++gene) {
+        const auto val = random.uniform(bounds.first, bounds.second);
+        const auto code = GeneticOperators::encode(val, bitsPerGene, bounds);
+
+        GeneticOperators::insert(codes, gene, bitsPerGene, code);
+    }
 }
@@ -6,5 +6,15 @@ class IndividualFactory final
 {
 public:
     static Individual create(const Population::IndividualType individualType,
-                             const uint8_t dimenions, const Population::Bounds& bounds);
+                             const size_t dimentions, const Population::Bounds& bounds, Random& random,
+                             const uint8_t bitsPerGene = 8,
+                             const Population::GenePrecision precision = Population::GenePrecision::Double);
+
+    //! Fill a row of a GenePool in place.
+    static void create(std::span<double> genes, const Population::Bounds& bounds, Random& random);
+    //! Real row \a ix of \a pool, whatever its precision.
+    static void create(GenePool& pool, const size_t ix, const Population::Bounds& bounds, Random& random);
+    //! Packed row of \a dimentions Gray codes, \a bitsPerGene bits each.
+    static void create(std::span<GenePool::Code> codes, const size_t dimentions, const uint8_t bitsPerGene,
+                       const Population::Bounds& bounds, Random& random);
 };
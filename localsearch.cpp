@@ -0,0 +1,289 @@
+#include "localsearch.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+
+using Bounds = LocalSearch::Bounds;
+
+//! Steps below this fraction of the bounds' width are not worth a call.
+constexpr double MinStep = 1e-12;
+//! 1/5 success rule: at one success in five the step size stays put.
+constexpr double SuccessFactor = 1.5;
+const double FailureFactor = std::pow(SuccessFactor, -0.25);
+
+//! The fitness function, metered against the budget.
+struct Objective
+{
+    double (*call)(const void*, std::span<double>);
+    const void* context;
+    uint64_t budget;
+    uint64_t calls = 0;
+
+    bool spent() const { return calls >= budget; }
+
+    double operator()(std::span<double> point)
+    {
+        ++calls;
+        return call(context, point);
+    }
+};
+
+void coordinateDescent(std::span<double> genes, double& fitness, const Bounds& bounds, const double step,
+                       Random& random, LocalSearch::Scratch& scratch, Objective& objective)
+{
+    const auto dimentions = genes.size();
+    const auto width = bounds.second - bounds.first;
+    auto& trial = scratch.trial;
+    trial.assign(genes.begin(), genes.end());
+
+    for (auto h = step * width; !objective.spent() && h > MinStep * width;) {
+        bool improved = false;
+        const auto first = random.index(dimentions);
+
+        for (size_t k = 0; k < dimentions && !objective.spent(); ++k) {
+            const auto i = (first + k) % dimentions;
+
+            for (const auto direction : {1.0, -1.0}) {
+                trial[i] = std::clamp(genes[i] + direction * h, bounds.first, bounds.second);
+
+                if (trial[i] == genes[i]) {
+                    continue;
+                }
+
+                const auto value = objective(trial);
+
+                if (value < fitness) {
+                    fitness = value;
+                    std::ranges::copy(trial, genes.begin());
+                    improved = true;
+                    break;
+                }
+
+                //! The evaluation may have moved any gene onto the encoding's grid.
+                std::ranges::copy(genes, trial.begin());
+
+                if (objective.spent()) {
+                    break;
+                }
+            }
+        }
+
+        if (!improved) {
+            h *= 0.5;
+        }
+    }
+}
+
+void nelderMead(std::span<double> genes, double& fitness, const Bounds& bounds, const double step,
+                LocalSearch::Scratch& scratch, Objective& objective)
+{
+    const auto dimentions = genes.size();
+
+    if (objective.budget <= dimentions) {
+        return;
+    }
+
+    auto& simplex = scratch.simplex;
+    auto& values = scratch.values;
+    auto& sum = scratch.sum;
+    auto& reflected = scratch.reflected;
+    auto& moved = scratch.moved;
+
+    simplex.resize((dimentions + 1) * dimentions);
+    values.resize(dimentions + 1);
+    sum.resize(dimentions);
+    reflected.resize(dimentions);
+    moved.resize(dimentions);
+
+    const auto vertex = [&](const size_t v) { return std::span<double>(simplex).subspan(v * dimentions, dimentions); };
+    const auto resum = [&]() {
+        std::ranges::fill(sum, 0.0);
+
+        for (size_t v = 0; v <= dimentions; ++v) {
+            const auto x = vertex(v);
+
+            for (size_t i = 0; i < dimentions; ++i) {
+                sum[i] += x[i];
+            }
+        }
+    };
+    const auto replace = [&](const size_t v, std::span<const double> point, const double value) {
+        const auto x = vertex(v);
+
+        for (size_t i = 0; i < dimentions; ++i) {
+            sum[i] += point[i] - x[i];
+        }
+
+        std::ranges::copy(point, x.begin());
+        values[v] = value;
+    };
+    //! centroid + coefficient * (centroid - worst), the centroid being over every
+    //! vertex but the worst.
+    const auto through = [&](const size_t worst, const double coefficient, std::span<double> out) {
+        const auto x = vertex(worst);
+
+        for (size_t i = 0; i < dimentions; ++i) {
+            const auto centroid = (sum[i] - x[i]) / dimentions;
+            out[i] = std::clamp(centroid + coefficient * (centroid - x[i]), bounds.first, bounds.second);
+        }
+    };
+
+    //! A vertex one step along each axis, or back from it at the upper bound.
+    const auto h = step * (bounds.second - bounds.first);
+    std::ranges::copy(genes, vertex(0).begin());
+    values[0] = fitness;
+
+    for (size_t v = 1; v <= dimentions; ++v) {
+        const auto x = vertex(v);
+        const auto i = v - 1;
+
+        std::ranges::copy(genes, x.begin());
+        x[i] = genes[i] + h <= bounds.second ? genes[i] + h : genes[i] - h;
+        values[v] = objective(x);
+    }
+
+    resum();
+
+    while (!objective.spent()) {
+        size_t best = 0;
+        size_t worst = 0;
+
+        for (size_t v = 1; v <= dimentions; ++v) {
+            best = values[v] < values[best] ? v : best;
+            worst = values[v] > values[worst] ? v : worst;
+        }
+
+        size_t second = best;
+
+        for (size_t v = 0; v <= dimentions; ++v) {
+            second = v != worst && values[v] > values[second] ? v : second;
+        }
+
+        if (values[worst] - values[best] <= MinStep * std::abs(values[best])) {
+            break;
+        }
+
+        through(worst, 1.0, reflected);
+        const auto reflectedValue = objective(reflected);
+
+        if (reflectedValue < values[best]) {
+            if (objective.spent()) {
+                replace(worst, reflected, reflectedValue);
+                break;
+            }
+
+            through(worst, 2.0, moved);
+            const auto expandedValue = objective(moved);
+
+            if (expandedValue < reflectedValue) {
+                replace(worst, moved, expandedValue);
+            } else {
+                replace(worst, reflected, reflectedValue);
+            }
+
+            continue;
+        }
+
+        if (reflectedValue < values[second]) {
+            replace(worst, reflected, reflectedValue);
+            continue;
+        }
+
+        if (objective.spent()) {
+            break;
+        }
+
+        //! Contracts towards the reflected point when it beats the worst vertex, towards
+        //! the worst vertex otherwise.
+        through(worst, reflectedValue < values[worst] ? 0.5 : -0.5, moved);
+        const auto contractedValue = objective(moved);
+
+        if (contractedValue < std::min(reflectedValue, values[worst])) {
+            replace(worst, moved, contractedValue);
+            continue;
+        }
+
+        const auto anchor = vertex(best);
+
+        for (size_t v = 0; v <= dimentions && !objective.spent(); ++v) {
+            if (v == best) {
+                continue;
+            }
+
+            const auto x = vertex(v);
+
+            for (size_t i = 0; i < dimentions; ++i) {
+                x[i] = anchor[i] + 0.5 * (x[i] - anchor[i]);
+            }
+
+            values[v] = objective(x);
+        }
+
+        resum();
+    }
+
+    const auto best = static_cast<size_t>(std::distance(values.begin(), std::ranges::min_element(values)));
+
+    if (values[best] < fitness) {
+        fitness = values[best];
+        std::ranges::copy(vertex(best), genes.begin());
+    }
+}
+
+void hillClimber(std::span<double> genes, double& fitness, const Bounds& bounds, const double step,
+                 Random& random, LocalSearch::Scratch& scratch, Objective& objective)
+{
+    const auto width = bounds.second - bounds.first;
+    auto& trial = scratch.trial;
+    trial.resize(genes.size());
+
+    //! Per gene, so that a whole step is about step * width long whatever the dimension.
+    auto sigma = step * width / std::sqrt(static_cast<double>(genes.size()));
+
+    while (!objective.spent() && sigma > MinStep * width) {
+        for (size_t i = 0; i < genes.size(); ++i) {
+            trial[i] = std::clamp(genes[i] + random.normal() * sigma, bounds.first, bounds.second);
+        }
+
+        const auto value = objective(trial);
+
+        if (value < fitness) {
+            fitness = value;
+            std::ranges::copy(trial, genes.begin());
+            sigma = std::min(sigma * SuccessFactor, width);
+        } else {
+            sigma *= FailureFactor;
+        }
+    }
+}
+
+} // namespace
+
+uint64_t LocalSearch::search(const Settings& settings, std::span<double> genes, double& fitness, const Bounds& bounds,
+                             Random& random, Scratch& scratch, Call call, const void* context)
+{
+    if (genes.empty() || settings.evaluations == 0 || !(bounds.second > bounds.first)) {
+        return 0;
+    }
+
+    Objective objective{call, context, settings.evaluations};
+
+    switch (settings.method) {
+    case Method::None:
+        break;
+    case Method::CoordinateDescent:
+        coordinateDescent(genes, fitness, bounds, settings.step, random, scratch, objective);
+        break;
+    case Method::NelderMead:
+        nelderMead(genes, fitness, bounds, settings.step, scratch, objective);
+        break;
+    case Method::HillClimber:
+        hillClimber(genes, fitness, bounds, settings.step, random, scratch, objective);
+        break;
+    }
+
+    return objective.calls;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "random.h"
+
+//! Bounded local search around one real genome, for the memetic stage of a run (see
+//! GeneticAlgo::PopulationSettings::localSearch). Every method starts from a genome of
+//! known fitness, makes at most settings.evaluations fitness calls, never leaves the
+//! bounds and only ever moves to a strictly fitter point.
+class LocalSearch final
+{
+public:
+    using Bounds = std::pair<double, double>;
+
+    //! CoordinateDescent steps one gene at a time both ways, halving the step after a
+    //! sweep without progress. NelderMead runs the downhill simplex; it needs
+    //! dimentions + 1 calls to build the simplex and leaves the genome alone when the
+    //! budget is smaller. HillClimber is a (1+1) evolution strategy, Gaussian steps on
+    //! every gene with the step size adapted by the 1/5 success rule.
+    enum class Method
+    {
+        None = 0,
+        CoordinateDescent,
+        NelderMead,
+        HillClimber
+    };
+
+    struct Settings
+    {
+        Method method = Method::None;
+        //! Fittest individuals searched around every epoch.
+        uint32_t elites = 4;
+        //! Fitness calls per elite and epoch.
+        uint32_t evaluations = 32;
+        //! First step, as a fraction of the bounds' width.
+        double step = 0.05;
+    };
+
+    //! Kept by the caller between searches, one per thread.
+    struct Scratch
+    {
+        std::vector<double> trial;
+        std::vector<double> simplex;
+        std::vector<double> values;
+        std::vector<double> sum;
+        std::vector<double> reflected;
+        std::vector<double> moved;
+    };
+
+    //! Moves \a genes of fitness \a fitness to the best point found, updating \a fitness,
+    //! and returns the fitness calls made. evaluate(std::span<double> point) returns the
+    //! fitness of point; it may first move point onto the nearest genome the encoding
+    //! can hold, so that the search only visits genomes it can store.
+    template<class Evaluate>
+    static uint64_t improve(const Settings& settings, std::span<double> genes, double& fitness, const Bounds& bounds,
+                            Random& random, Scratch& scratch, const Evaluate& evaluate)
+    {
+        return search(
+            settings, genes, fitness, bounds, random, scratch,
+            [](const void* context, std::span<double> point) {
+                return (*static_cast<const Evaluate*>(context))(point);
+            },
+            &evaluate);
+    }
+
+private:
+    using Call = double (*)(const void*, std::span<double>);
+
+    static uint64_t search(const Settings& settings, std::span<double> genes, double& fitness, const Bounds& bounds,
+                           Random& random, Scratch& scratch, Call call, const void* context);
+};
@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <optional>
 #include <vector>
 
 #define _USE_MATH_DEFINES
@@ -7,6 +9,7 @@
 
 //Турнир Ранговый Дискретная Триадный Низкая/высокая вероятность Вещ. числа/ Код Грея
 #include "geneticalgo.h"
+#include "benchmarkfunctions.h"
 
 const auto print = [](const auto& vec) {
     std::cout << "[";
@@ -20,17 +23,7 @@ const auto print = [](const auto& vec) {
 
 int main()
 {
-    const auto Michalewicz = [](const std::vector<double>& x) {
-        double result = 0.0;
-        constexpr int m = 1;
-
-        for (int i = 0; i < x.size(); ++i) {
-            const auto sinArg = ((i + 1) / M_PI) * std::pow(x[i], 2);
-            result += std::sin(x[i]) * std::pow(std::sin(sinArg), 2 * m);
-        }
-
-        return -result;
-    };
+    const Michalewicz michalewicz{.m = 1};
 
     GeneticAlgo::PopulationSettings settings;
     settings.size = 5;
@@ -40,25 +33,51 @@ int main()
     settings.selection = Population::SelectionType::Rank;
     settings.crossover = Population::CrossoverType::TwoPoint;
     settings.mutationChance = 0.05;
+    settings.bitsPerGene = 16;
 
     constexpr auto target = -4.650;
 
-    Population::Individuals inds;
     GeneticAlgo algo(100);
 
-    for (int i = 0; i < 100 ; i++) {
-        const auto ind = algo.run(settings, Michalewicz, target);
-        std::cout << ind.toString() << std::endl;
-        inds.push_back(ind);
+    std::ofstream telemetryFile("telemetry.csv");
+    StreamTelemetry telemetry(telemetryFile);
+    algo.setTelemetry(telemetry);
+
+    const auto batch = algo.runBatch(settings, GeneticAlgo::BatchSettings{.runs = 100}, michalewicz, target);
+
+    for (const auto& run : batch.runs) {
+        std::cout << run.best.toString() << std::endl;
     }
 
-    const auto minFitnessPred = [](const auto& ind, const auto& other) -> bool {
-        return ind.fitness() < other.fitness();
+    const auto printQuantiles = [](const char* name, const std::optional<Statistics::Quantiles>& quantiles) {
+        if (!quantiles) {
+            std::cout << name << ": n/a" << std::endl;
+            return;
+        }
+
+        const auto& q = *quantiles;
+        std::cout << name << ": min " << q.min << ", q25 " << q.q25 << ", median " << q.median << ", q75 " << q.q75
+                  << ", max " << q.max << ", mean " << q.mean << std::endl;
     };
 
-    const auto minElem = *std::ranges::min_element(inds, minFitnessPred);
+    std::cout << "best of " << batch.runs.size() << ": " << batch.best.toString() << std::endl;
+    printQuantiles("fitness", batch.fitness);
+    std::cout << "reached target: " << batch.reachedTarget << "/" << batch.runs.size() << std::endl;
+    printQuantiles("evaluations to target", batch.evaluationsToTarget);
+    printQuantiles("seconds to target", batch.secondsToTarget);
+
+    //! The same batch with a memetic stage: coordinate descent around the best
+    //! individual every epoch, its calls counted in the evaluations to target.
+    settings.localSearch.method = LocalSearch::Method::CoordinateDescent;
+    settings.localSearch.elites = 1;
+    settings.localSearch.evaluations = 20;
+
+    const auto memetic = algo.runBatch(settings, GeneticAlgo::BatchSettings{.runs = 100}, michalewicz, target);
 
-    std::cout << "best of 100: " << minElem.toString() << std::endl;
+    std::cout << "with local search, best of " << memetic.runs.size() << ": " << memetic.best.toString() << std::endl;
+    printQuantiles("fitness", memetic.fitness);
+    std::cout << "reached target: " << memetic.reachedTarget << "/" << memetic.runs.size() << std::endl;
+    printQuantiles("evaluations to target", memetic.evaluationsToTarget);
 
     return 0;
 }
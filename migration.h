@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "random.h"
+
+//! Which islands send migrants to which.
+enum class IslandTopology
+{
+    Ring = 0,
+    Full,
+    Random
+};
+
+//! Single producer, single consumer mailbox for batches of migrants. It is a triple
+//! buffer: the sender fills its own slot and swaps it with the shared one, the
+//! receiver swaps the shared one with its own slot when it holds something new.
+//! Neither side ever waits or allocates; a batch that was not picked up in time is
+//! replaced by the next one.
+template<class Pool>
+class Mailbox final
+{
+public:
+    explicit Mailbox(const Pool& empty)
+        : m_slots{empty, empty, empty}
+    {}
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    //! Sender side: fill outbox(), then post() it.
+    Pool& outbox() { return m_slots[m_back]; }
+
+    void post()
+    {
+        m_back = m_shared.exchange(m_back | Fresh, std::memory_order_acq_rel) & Slot;
+    }
+
+    //! Receiver side: the latest batch not seen yet, nullptr if there is none.
+    const Pool* receive()
+    {
+        if (!(m_shared.load(std::memory_order_relaxed) & Fresh)) {
+            return nullptr;
+        }
+
+        m_front = m_shared.exchange(m_front, std::memory_order_acq_rel) & Slot;
+        return &m_slots[m_front];
+    }
+
+private:
+    static constexpr uint8_t Slot = 3;
+    static constexpr uint8_t Fresh = 4;
+
+    std::array<Pool, 3> m_slots;
+    alignas(64) uint8_t m_back = 0;
+    alignas(64) std::atomic<uint8_t> m_shared{1};
+    alignas(64) uint8_t m_front = 2;
+};
+
+//! Mailboxes between the islands of an island model, one per connected pair. Every
+//! island calls send() and receive() from its own thread only, so each mailbox has
+//! exactly one producer and one consumer.
+template<class Pool>
+class Migration final
+{
+public:
+    Migration(const size_t islands, const IslandTopology topology, const Pool& shape, const size_t migrants)
+        : m_islands{islands}
+        , m_topology{topology}
+        , m_mailboxes(islands * islands)
+    {
+        m_staging.reserve(islands);
+
+        for (size_t from = 0; from < islands; ++from) {
+            m_staging.push_back(shape.withSize(migrants));
+
+            for (size_t to = 0; to < islands; ++to) {
+                if (connected(from, to)) {
+                    m_mailboxes[from * islands + to] = std::make_unique<Mailbox<Pool>>(shape.withSize(migrants));
+                }
+            }
+        }
+    }
+
+    //! Posts the fittest individuals of \a island to its neighbours, a single random
+    //! one for IslandTopology::Random.
+    template<class PopulationType>
+    void send(const size_t island, PopulationType& population)
+    {
+        if (m_islands < 2) {
+            return;
+        }
+
+        auto& migrants = m_staging[island];
+        population.emigrate(migrants);
+
+        switch (m_topology) {
+        case IslandTopology::Ring:
+            post(island, (island + 1) % m_islands, migrants);
+            break;
+        case IslandTopology::Full:
+            for (size_t to = 0; to < m_islands; ++to) {
+                if (to != island) {
+                    post(island, to, migrants);
+                }
+            }
+            break;
+        case IslandTopology::Random: {
+            auto to = population.random().index(m_islands - 1);
+            post(island, to < island ? to : to + 1, migrants);
+            break;
+        }
+        }
+    }
+
+    //! Lets whatever arrived for \a island since the last call replace its weakest individuals.
+    template<class PopulationType>
+    void receive(const size_t island, PopulationType& population)
+    {
+        for (size_t from = 0; from < m_islands; ++from) {
+            if (auto& mailbox = m_mailboxes[from * m_islands + island]) {
+                if (const auto* migrants = mailbox->receive()) {
+                    population.immigrate(*migrants);
+                }
+            }
+        }
+    }
+
+private:
+    bool connected(const size_t from, const size_t to) const
+    {
+        if (from == to) {
+            return false;
+        }
+
+        return m_topology != IslandTopology::Ring || to == (from + 1) % m_islands;
+    }
+
+    void post(const size_t from, const size_t to, const Pool& migrants)
+    {
+        auto& mailbox = *m_mailboxes[from * m_islands + to];
+        auto& outbox = mailbox.outbox();
+
+        for (size_t i = 0; i < migrants.size(); ++i) {
+            outbox.copyRow(i, migrants, i);
+        }
+
+        mailbox.post();
+    }
+
+    size_t m_islands;
+    IslandTopology m_topology;
+    std::vector<std::unique_ptr<Mailbox<Pool>>> m_mailboxes;
+    std::vector<Pool> m_staging;
+};
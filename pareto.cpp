@@ -0,0 +1,443 @@
+#include "pareto.h"
+
+#include <limits>
+#include <ranges>
+#include <numeric>
+#include <iterator>
+#include <algorithm>
+
+namespace
+{
+
+//! Rows with the lowest objective 1 value seen for each rank, ranks rising with the
+//! value, so the best rank below a value is one binary search. There are at most as
+//! many steps as fronts, so a flat vector beats a tree.
+class Staircase final
+{
+public:
+    struct Step
+    {
+        double value;
+        uint32_t rank;
+    };
+
+    explicit Staircase(std::vector<Step>& steps)
+        : m_steps{steps}
+    {
+        m_steps.clear();
+    }
+
+    //! Highest rank of a row whose objective 1 is at most \a value, -1 for none.
+    int64_t below(const double value) const
+    {
+        const auto it = std::ranges::upper_bound(m_steps, value, {}, &Step::value);
+        return it == m_steps.begin() ? -1 : int64_t{std::prev(it)->rank};
+    }
+
+    void insert(const double value, const uint32_t rank)
+    {
+        if (below(value) >= int64_t{rank}) {
+            return;
+        }
+
+        const auto first = std::ranges::lower_bound(m_steps, value, {}, &Step::value);
+        const auto last = std::find_if(first, m_steps.end(), [rank](const auto& step) { return step.rank > rank; });
+
+        if (first == last) {
+            m_steps.insert(first, Step{value, rank});
+        } else {
+            *first = Step{value, rank};
+            m_steps.erase(first + 1, last);
+        }
+    }
+
+private:
+    std::vector<Step>& m_steps;
+};
+
+//! Ranks distinct points sorted lexicographically, rank of a point being one more
+//! than the highest rank of the points dominating it. Lists of points are positions
+//! into the sorted order and stay sorted. helperA(S, k) ranks S on objectives 0..k,
+//! all of S sharing the objectives above k; helperB(L, H, k) raises the ranks of H
+//! by those of L, every row of L being no worse than every row of H above k and
+//! having its final rank already.
+class Ranker final
+{
+public:
+    using Points = std::vector<uint32_t>;
+
+    Ranker(std::span<const double> points, const size_t objectives, std::vector<uint32_t>& ranks)
+        : m_points{points}
+        , m_objectives{objectives}
+        , m_ranks{ranks}
+    {}
+
+    void run(const size_t count)
+    {
+        Points all(count);
+        std::iota(all.begin(), all.end(), uint32_t{});
+
+        if (m_objectives == 1) {
+            //! Distinct single values: each one dominates all the later ones.
+            m_ranks = all;
+        } else {
+            helperA(all, m_objectives - 1);
+        }
+    }
+
+private:
+    //! Below this many points recursing costs more than comparing every pair.
+    static constexpr size_t BruteForce = 32;
+
+    double at(const uint32_t point, const size_t objective) const { return m_points[point * m_objectives + objective]; }
+
+    bool weaklyDominates(const uint32_t a, const uint32_t b, const size_t k) const
+    {
+        for (size_t i = 0; i <= k; ++i) {
+            if (at(a, i) > at(b, i)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void raise(const uint32_t point, const uint32_t by) { m_ranks[point] = std::max(m_ranks[point], m_ranks[by] + 1); }
+
+    double median(const Points& a, const Points& b, const size_t k)
+    {
+        m_values.clear();
+
+        for (const auto point : a) {
+            m_values.push_back(at(point, k));
+        }
+
+        for (const auto point : b) {
+            m_values.push_back(at(point, k));
+        }
+
+        const auto middle = m_values.begin() + m_values.size() / 2;
+        std::nth_element(m_values.begin(), middle, m_values.end());
+
+        return *middle;
+    }
+
+    void split(const Points& points, const size_t k, const double pivot, Points& less, Points& equal, Points& greater) const
+    {
+        for (const auto point : points) {
+            const auto value = at(point, k);
+            (value < pivot ? less : value > pivot ? greater : equal).push_back(point);
+        }
+    }
+
+    static Points merge(const Points& a, const Points& b)
+    {
+        Points merged;
+        merged.reserve(a.size() + b.size());
+        std::ranges::merge(a, b, std::back_inserter(merged));
+        return merged;
+    }
+
+    void helperA(const Points& points, const size_t k)
+    {
+        if (points.size() < 2) {
+            return;
+        }
+
+        //! In sorted order a point can only be dominated by earlier ones.
+        if (points.size() <= BruteForce) {
+            for (size_t i = 1; i < points.size(); ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (weaklyDominates(points[j], points[i], k)) {
+                        raise(points[i], points[j]);
+                    }
+                }
+            }
+
+            return;
+        }
+
+        if (k == 1) {
+            return sweepA(points);
+        }
+
+        const auto [low, high] = std::ranges::minmax(points | std::views::transform([&](const auto p) { return at(p, k); }));
+
+        if (low == high) {
+            return helperA(points, k - 1);
+        }
+
+        const auto pivot = median(points, {}, k);
+        Points less, equal, greater;
+        split(points, k, pivot, less, equal, greater);
+
+        helperA(less, k);
+        helperB(less, equal, k - 1);
+        helperA(equal, k - 1);
+        helperB(merge(less, equal), greater, k - 1);
+        helperA(greater, k);
+    }
+
+    void helperB(const Points& low, const Points& high, const size_t k)
+    {
+        if (low.empty() || high.empty()) {
+            return;
+        }
+
+        if (low.size() * high.size() <= BruteForce * BruteForce) {
+            for (const auto h : high) {
+                for (const auto l : low) {
+                    if (weaklyDominates(l, h, k)) {
+                        raise(h, l);
+                    }
+                }
+            }
+
+            return;
+        }
+
+        if (k == 1) {
+            return sweepB(low, high);
+        }
+
+        const auto value = [&](const auto p) { return at(p, k); };
+        const auto [lowMin, lowMax] = std::ranges::minmax(low | std::views::transform(value));
+        const auto [highMin, highMax] = std::ranges::minmax(high | std::views::transform(value));
+
+        if (lowMax <= highMin) {
+            return helperB(low, high, k - 1);
+        }
+
+        if (lowMin > highMax) {
+            return;
+        }
+
+        const auto pivot = median(low, high, k);
+        Points low1, low2, low3, high1, high2, high3;
+        split(low, k, pivot, low1, low2, low3);
+        split(high, k, pivot, high1, high2, high3);
+
+        helperB(low1, high1, k);
+        helperB(low3, high3, k);
+        helperB(merge(low1, low2), merge(high2, high3), k - 1);
+    }
+
+    //! Two objectives left: in sorted order every earlier point is no worse on
+    //! objective 0, so it dominates when no worse on objective 1.
+    void sweepA(const Points& points)
+    {
+        Staircase stairs(m_steps);
+
+        for (const auto point : points) {
+            const auto above = stairs.below(at(point, 1));
+
+            if (above >= 0) {
+                m_ranks[point] = std::max<uint32_t>(m_ranks[point], static_cast<uint32_t>(above) + 1);
+            }
+
+            stairs.insert(at(point, 1), m_ranks[point]);
+        }
+    }
+
+    void sweepB(const Points& low, const Points& high)
+    {
+        Staircase stairs(m_steps);
+        size_t l = 0;
+
+        for (const auto point : high) {
+            for (; l < low.size() && low[l] < point; ++l) {
+                stairs.insert(at(low[l], 1), m_ranks[low[l]]);
+            }
+
+            const auto above = stairs.below(at(point, 1));
+
+            if (above >= 0) {
+                m_ranks[point] = std::max<uint32_t>(m_ranks[point], static_cast<uint32_t>(above) + 1);
+            }
+        }
+    }
+
+    std::span<const double> m_points;
+    size_t m_objectives;
+    std::vector<uint32_t>& m_ranks;
+    std::vector<double> m_values;
+    std::vector<Staircase::Step> m_steps;
+};
+
+} // namespace
+
+uint32_t Pareto::sort(std::span<const double> values, const size_t objectives, std::vector<uint32_t>& fronts,
+                      Scratch& scratch)
+{
+    const auto rows = objectives > 0 ? values.size() / objectives : 0;
+    const auto row = [&](const uint32_t ix) { return values.subspan(ix * objectives, objectives); };
+
+    fronts.assign(rows, 0);
+
+    if (rows == 0) {
+        return 0;
+    }
+
+    auto& order = scratch.order;
+    order.resize(rows);
+    std::iota(order.begin(), order.end(), uint32_t{});
+    std::ranges::sort(order, [&](const auto a, const auto b) { return std::ranges::lexicographical_compare(row(a), row(b)); });
+
+    //! Identical rows collapse into one point.
+    auto& position = scratch.position;
+    auto& points = scratch.points;
+    position.resize(rows);
+    points.clear();
+
+    for (size_t i = 0; i < rows; ++i) {
+        if (i == 0 || !std::ranges::equal(row(order[i]), row(order[i - 1]))) {
+            points.insert(points.end(), row(order[i]).begin(), row(order[i]).end());
+        }
+
+        position[order[i]] = static_cast<uint32_t>(points.size() / objectives - 1);
+    }
+
+    auto& ranks = scratch.ranks;
+    const auto count = points.size() / objectives;
+    ranks.assign(count, 0);
+    Ranker(points, objectives, ranks).run(count);
+
+    uint32_t last = 0;
+
+    for (size_t i = 0; i < rows; ++i) {
+        fronts[i] = ranks[position[i]];
+        last = std::max(last, fronts[i]);
+    }
+
+    return last + 1;
+}
+
+void Pareto::crowding(std::span<const double> values, const size_t objectives, std::span<const uint32_t> members,
+                      std::span<double> distance, Scratch& scratch)
+{
+    const auto size = members.size();
+
+    if (size <= 2) {
+        for (const auto member : members) {
+            distance[member] = std::numeric_limits<double>::infinity();
+        }
+
+        return;
+    }
+
+    auto& order = scratch.order;
+    auto& sorted = scratch.sorted;
+    auto& gaps = scratch.gaps;
+    order.resize(size);
+    sorted.resize(size);
+    gaps.resize(size);
+
+    for (size_t objective = 0; objective < objectives; ++objective) {
+        const auto value = [&](const uint32_t i) { return values[members[i] * objectives + objective]; };
+
+        std::iota(order.begin(), order.end(), uint32_t{});
+        std::ranges::sort(order, {}, value);
+
+        for (size_t i = 0; i < size; ++i) {
+            sorted[i] = value(order[i]);
+        }
+
+        distance[members[order.front()]] = distance[members[order.back()]] = std::numeric_limits<double>::infinity();
+
+        const auto extent = sorted.back() - sorted.front();
+
+        if (!(extent > 0.0)) {
+            continue;
+        }
+
+        //! Contiguous and branch free, so it vectorizes; the scatter comes after.
+        const auto scale = 1.0 / extent;
+
+        for (size_t i = 1; i + 1 < size; ++i) {
+            gaps[i] = (sorted[i + 1] - sorted[i - 1]) * scale;
+        }
+
+        for (size_t i = 1; i + 1 < size; ++i) {
+            distance[members[order[i]]] += gaps[i];
+        }
+    }
+}
+
+void Pareto::select(std::span<const double> values, const size_t objectives, const size_t size,
+                    std::vector<uint32_t>& survivors, std::vector<uint32_t>& fronts, std::vector<double>& crowding,
+                    Scratch& scratch)
+{
+    const auto rows = objectives > 0 ? values.size() / objectives : 0;
+    const auto count = sort(values, objectives, fronts, scratch);
+
+    //! Rows bucketed by front, counting sort.
+    auto& offsets = scratch.offsets;
+    auto& members = scratch.members;
+    offsets.assign(count + 1, 0);
+
+    for (const auto front : fronts) {
+        ++offsets[front + 1];
+    }
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    members.resize(rows);
+
+    for (size_t i = 0; i < rows; ++i) {
+        members[offsets[fronts[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    std::shift_right(offsets.begin(), offsets.end(), 1);
+    offsets[0] = 0;
+
+    crowding.assign(rows, 0.0);
+    survivors.clear();
+
+    for (uint32_t front = 0; front < count && survivors.size() < size; ++front) {
+        const auto first = members.begin() + offsets[front];
+        const auto last = members.begin() + offsets[front + 1];
+
+        Pareto::crowding(values, objectives, std::span<const uint32_t>(first, last), crowding, scratch);
+
+        if (survivors.size() + (last - first) > size) {
+            const auto keep = first + (size - survivors.size());
+            std::nth_element(first, keep, last, [&](const auto a, const auto b) {
+                return crowding[a] > crowding[b] || (crowding[a] == crowding[b] && a < b);
+            });
+            survivors.insert(survivors.end(), first, keep);
+        } else {
+            survivors.insert(survivors.end(), first, last);
+        }
+    }
+}
+
+void Pareto::tournament(std::span<const uint32_t> fronts, std::span<const double> crowding, Random& random,
+                        Parents& parents, const size_t count)
+{
+    parents.resize(count);
+
+    std::ranges::generate(parents, [&]() {
+        const auto a = static_cast<uint32_t>(random.index(fronts.size()));
+        const auto b = static_cast<uint32_t>(random.index(fronts.size()));
+
+        if (fronts[a] != fronts[b]) {
+            return fronts[a] < fronts[b] ? a : b;
+        }
+
+        return crowding[b] > crowding[a] ? b : a;
+    });
+}
+
+bool Pareto::dominates(std::span<const double> a, std::span<const double> b)
+{
+    bool better = false;
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] > b[i]) {
+            return false;
+        }
+
+        better = better || a[i] < b[i];
+    }
+
+    return better;
+}
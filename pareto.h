@@ -0,0 +1,56 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+#include "random.h"
+#include "selection.h"
+
+//! Pareto ranking for multi-objective runs, every objective minimized. Objective values
+//! come as a row-major matrix, \a objectives values per row; they must not be NaN.
+class Pareto final
+{
+public:
+    using Parents = Selection::Parents;
+
+    //! Kept by the caller between generations, so ranking stops allocating once warm.
+    struct Scratch
+    {
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> position;
+        std::vector<double> points;
+        std::vector<uint32_t> ranks;
+        std::vector<uint32_t> members;
+        std::vector<uint32_t> offsets;
+        std::vector<double> sorted;
+        std::vector<double> gaps;
+    };
+
+    //! Fills fronts[row] with the front of every row, 0 for the non-dominated ones, and
+    //! returns the number of fronts. Jensen's divide and conquer as generalized by
+    //! Buzdalov and Shalyto, O(N log^(M-1) N) for N rows of M objectives and a plain
+    //! O(N log N) sweep for two. Identical rows share a front.
+    static uint32_t sort(std::span<const double> values, const size_t objectives, std::vector<uint32_t>& fronts,
+                         Scratch& scratch);
+
+    //! Adds the crowding distance of every row of \a members, one front, to
+    //! distance[row]: per objective, the gap between its neighbours in the front
+    //! over the front's extent. The extremes get infinity.
+    static void crowding(std::span<const double> values, const size_t objectives, std::span<const uint32_t> members,
+                         std::span<double> distance, Scratch& scratch);
+
+    //! NSGA-II survival: the \a size best rows by front, the last front that fits only
+    //! partly being thinned by crowding distance. Fills \a fronts and \a crowding for
+    //! every row and \a survivors with the row indices kept.
+    static void select(std::span<const double> values, const size_t objectives, const size_t size,
+                       std::vector<uint32_t>& survivors, std::vector<uint32_t>& fronts, std::vector<double>& crowding,
+                       Scratch& scratch);
+
+    //! Binary tournaments for \a count parents: the lower front wins, then the larger
+    //! crowding distance.
+    static void tournament(std::span<const uint32_t> fronts, std::span<const double> crowding, Random& random,
+                           Parents& parents, const size_t count);
+
+    static bool dominates(std::span<const double> a, std::span<const double> b);
+};
@@ -1,267 +1,287 @@
 #include "population.h"
 
 #include <algorithm>
-#include <numeric>
-#include <random>
+#include <memory>
 #include <cassert>
 #include <sstream>
 
 #include "individualfactory.h"
 
-Population::Population(const uint32_t size, const uint8_t dimentions,
-                       const IndividualType individualType, const Bounds& bounds)
+Population::Population(const uint32_t size, const size_t dimentions,
+                       const IndividualType individualType, const Bounds& bounds, const uint8_t bitsPerGene,
+                       const Random& random, const GenePrecision precision)
     : m_type{individualType}
+    , m_bounds{bounds}
+    , m_random{random}
 {
-    m_individuals.resize(size);
+    allocateGenerations(size, dimentions, static_cast<Individual::Type>(individualType), bitsPerGene, precision);
 
-    const auto generator = [&individualType, &dimentions, &bounds]() {
-        return IndividualFactory::create(individualType, dimentions, bounds);
-    };
-
-    std::ranges::generate(m_individuals, generator);
+    for (size_t i = 0; i < m_individuals.size(); ++i) {
+        if (individualType == IndividualType::GrayCode) {
+            IndividualFactory::create(m_individuals.codes(i), dimentions, bitsPerGene, bounds, m_random);
+        } else if (individualType == IndividualType::Discrete) {
+            IndividualFactory::create(m_individuals, i, bounds, m_random);
+        }
+    }
 }
 
-std::optional<Population::Individuals> Population::selection(const SelectionType selectionType)
+bool Population::selection(const SelectionType selectionType, Parents& parents, const SamplingType sampling)
 {
-    switch (selectionType) {
-    case SelectionType::None:
-        return std::nullopt;
-    case SelectionType::Tournament:
-        return tournamentSelection();
-    case SelectionType::Rank:
-        return rankSelection();
-    case SelectionType::Panmixia:
-        return panmixiaSelection();
-    case SelectionType::Proportional:
-        return proportionalSelection();
-    }
-
-    return std::nullopt;
+    return Selection::select(selectionType, m_individuals.fitnesses(), m_random, parents, m_selection, sampling);
 }
 
-Population::Individuals Population::tournamentSelection(const uint32_t tournamentSize)
+void Population::tournamentSelection(Parents& parents, const uint32_t tournamentSize)
 {
-    Individuals selected;
-    selected.resize(size());
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(0, static_cast<int>(size() - 1));
-
-    const auto select = [&, this]() {
-        Individuals competitors;
-        competitors.resize(tournamentSize);
-
-        std::ranges::generate(competitors, [this, &dist, &gen]() {
-            const size_t index = dist(gen);
-            return m_individuals[index];
-        });
-
-        const auto pred = [](const auto& a, const auto& b) {
-            return a.fitness() < b.fitness();
-        };
-
-        return *std::ranges::min_element(competitors, pred);
-    };
-
-    std::ranges::generate(selected, select);
-
-    return std::move(selected);
+    Selection::tournament(m_individuals.fitnesses(), m_random, parents, tournamentSize);
 }
 
-Population::Individuals Population::rankSelection()
+void Population::rankSelection(Parents& parents, const SamplingType sampling)
 {
-    auto sortedInds = m_individuals;
-
-    std::ranges::sort(sortedInds.begin(), sortedInds.end(), [](const auto& a, const auto& b) {
-        return a.fitness() < b.fitness();
-    });
-
-    return std::move(sortedInds);
+    Selection::rank(m_individuals.fitnesses(), m_random, parents, m_selection, sampling);
 }
 
-Population::Individuals Population::panmixiaSelection()
+void Population::exponentialRankSelection(Parents& parents, const SamplingType sampling)
 {
-    Individuals selected;
-    selected.reserve(size());
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(0, size() - 1);
-
-    std::ranges::transform(m_individuals, std::back_inserter(selected), [this, &dist, &gen](const auto&) {
-        return m_individuals[dist(gen)];
-    });
-
-    return std::move(selected);
+    Selection::exponentialRank(m_individuals.fitnesses(), m_random, parents, m_selection, sampling);
 }
 
-Population::Individuals Population::proportionalSelection()
+void Population::panmixiaSelection(Parents& parents)
 {
-    std::vector<double> probabilities;
-    probabilities.reserve(size());
-
-    const auto getProbabilities = [](const auto& ind) -> double {
-        return 1 / ind.fitness();
-    };
-
-    std::ranges::transform(m_individuals, std::back_inserter(probabilities), getProbabilities);
-    const auto total = std::accumulate(probabilities.begin(), probabilities.end(), double{});
-
-    const auto normalize = [&total](const double prob) {
-        return prob / total;
-    };
-
-    std::ranges::transform(probabilities, probabilities.begin(), normalize);
-
-    Individuals selected;
-    selected.resize(size());
+    Selection::panmixia(m_individuals.fitnesses(), m_random, parents);
+}
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::discrete_distribution<> dist(probabilities.begin(), probabilities.end());
+void Population::proportionalSelection(Parents& parents, const SamplingType sampling)
+{
+    Selection::proportional(m_individuals.fitnesses(), m_random, parents, m_selection, sampling);
+}
 
-    std::ranges::generate(selected, [this, &dist, &gen]() {
-        const auto ix = dist(gen);
-        return m_individuals[ix];
-    });
+bool Population::prepareSelection(const SelectionType selectionType, const SamplingType sampling)
+{
+    return Selection::prepare(selectionType, m_individuals.fitnesses(), m_random, m_selection, sampling);
+}
 
-    return selected;
+uint32_t Population::drawParent()
+{
+    return Selection::draw(m_individuals.fitnesses(), m_random, m_selection);
 }
 
-std::optional<Population::CrossoverResult> Population::crossover(const CrossoverType type, const Individual& parent1, const Individual& parent2)
+bool Population::crossover(const CrossoverType type, const size_t parent1, const size_t parent2,
+                           Individuals& children, const size_t child)
 {
+    const auto& parents = m_individuals;
+    const bool hasSecond = child + 1 < children.size();
+
     switch (type) {
     case CrossoverType::None:
-        return std::nullopt;
+        return false;
     case CrossoverType::Discrete:
         if (m_type != IndividualType::Discrete)
-            return std::nullopt;
+            return false;
 
-        return discreteCrossover(parent1, parent2);
+        if (parents.precision() != GenePrecision::Double) {
+            crossWidened(type, parent1, parent2, children, child, hasSecond);
+            break;
+        }
+
+        discreteCrossover(parents.genes(parent1), parents.genes(parent2),
+                          children.genes(child), hasSecond ? children.genes(child + 1) : GeneRow{});
+        break;
     case CrossoverType::Linear:
         if (m_type != IndividualType::Discrete)
-            return std::nullopt;
+            return false;
+
+        if (parents.precision() != GenePrecision::Double) {
+            crossWidened(type, parent1, parent2, children, child, hasSecond);
+            break;
+        }
 
-        return linearCrossover(parent1, parent2);
+        linearCrossover(parents.genes(parent1), parents.genes(parent2),
+                        children.genes(child), hasSecond ? children.genes(child + 1) : GeneRow{});
+        break;
     case CrossoverType::TwoPoint:
         if (m_type != IndividualType::GrayCode)
-            return std::nullopt;
+            return false;
+
+        twoPointCrossover(parents.codes(parent1), parents.codes(parent2),
+                          children.codes(child), hasSecond ? children.codes(child + 1) : CodeRow{});
+        break;
+    }
 
-        return twoPointCrossover(parent1, parent2);
+    GeneticOperators::inherit(m_individuals, children, child, parent1, parent2);
+
+    if (hasSecond) {
+        GeneticOperators::inherit(m_individuals, children, child + 1, parent1, parent2);
     }
 
-    return std::nullopt;
+    return true;
 }
 
-Population::CrossoverResult Population::discreteCrossover(const Individual& parent1, const Individual& parent2)
+void Population::crossWidened(const CrossoverType type, const size_t parent1, const size_t parent2,
+                              Individuals& children, const size_t child, const bool hasSecond)
 {
-    assert(parent1.size() == parent2.size());
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
-
-    Individual::Chromosomes child1Chromosomes;
-    Individual::Chromosomes child2Chromosomes;
+    const auto dimentions = m_individuals.dimentions();
+    const auto block = std::min(dimentions, GeneticOperators::BlockGenes);
+    m_widened.resize(4 * block);
+
+    for (size_t begin = 0; begin < dimentions; begin += block) {
+        const auto count = std::min(block, dimentions - begin);
+        const auto first = GeneRow(m_widened).subspan(0, count);
+        const auto second = GeneRow(m_widened).subspan(block, count);
+        const auto child1 = GeneRow(m_widened).subspan(2 * block, count);
+        const auto child2 = hasSecond ? GeneRow(m_widened).subspan(3 * block, count) : GeneRow{};
+
+        m_individuals.load(parent1, first, begin);
+        m_individuals.load(parent2, second, begin);
+
+        if (type == CrossoverType::Discrete) {
+            discreteCrossover(first, second, child1, child2);
+        } else {
+            linearCrossover(first, second, child1, child2);
+        }
 
-    const auto append = [](auto& to, const auto& from, const size_t ix) {
-        auto& toVec = std::get<Individual::Gene>(to);
-        const auto& fromVec = std::get<Individual::Gene>(from);
-        toVec.push_back(fromVec[ix]);
-    };
+        children.store(child, child1, begin);
 
-    for (size_t i = 0; i < parent1.size(); ++i) {
-        if (dis(gen) < 0.5) {
-            append(child1Chromosomes, parent1.chromosomes(), i);
-            append(child2Chromosomes, parent2.chromosomes(), i);
-        } else {
-            append(child1Chromosomes, parent2.chromosomes(), i);
-            append(child2Chromosomes, parent1.chromosomes(), i);
+        if (hasSecond) {
+            children.store(child + 1, child2, begin);
         }
     }
+}
 
-    Individual child1 = std::move(parent1);
-    Individual child2 = std::move(parent2);
+void Population::discreteCrossover(ConstGeneRow parent1, ConstGeneRow parent2, GeneRow child1, GeneRow child2)
+{
+    GeneticOperators::discreteCrossover(parent1, parent2, child1, child2, m_random);
+}
 
-    child1.setChromosomes(child1Chromosomes);
-    child2.setChromosomes(child2Chromosomes);
+void Population::linearCrossover(ConstGeneRow parent1, ConstGeneRow parent2, GeneRow child1, GeneRow child2)
+{
+    GeneticOperators::linearCrossover(parent1, parent2, child1, child2);
+}
 
-    return std::make_pair(child1, child2);
+void Population::twoPointCrossover(ConstCodeRow parent1, ConstCodeRow parent2, CodeRow child1, CodeRow child2)
+{
+    const auto totalBits = m_individuals.dimentions() * m_individuals.bitsPerGene();
+    GeneticOperators::twoPointCrossover(parent1, parent2, child1, child2, totalBits, m_random);
 }
 
-Population::CrossoverResult Population::linearCrossover(const Individual& parent1, const Individual& parent2)
+void Population::mutate(Individuals& individuals, const size_t ix, const double probability)
 {
-    const auto alpha = 0.5;
+    bool mutated = false;
 
-    Individual::Chromosomes child1Chromosomes;
-    Individual::Chromosomes child2Chromosomes;
+    if (individuals.type() == Individual::Type::Discrete && individuals.precision() != GenePrecision::Double) {
+        if (m_random.uniform() < probability) {
+            individuals.setGene(ix, m_random.index(individuals.dimentions()), m_random.uniform(m_bounds.first, m_bounds.second));
+            mutated = true;
+        }
+    } else if (individuals.type() == Individual::Type::Discrete) {
+        mutated = GeneticOperators::mutate(individuals.genes(ix), m_random, probability, m_bounds);
+    } else if (individuals.type() == Individual::Type::GrayCode) {
+        const auto totalBits = individuals.dimentions() * individuals.bitsPerGene();
+        mutated = GeneticOperators::flipMutate(individuals.codes(ix), m_random, probability, totalBits);
+    }
+
+    if (mutated) {
+        individuals.setDirty(ix, true);
+    }
+}
+
+bool Population::mutate(Individuals& individuals, const MutationType type, const double rate, const size_t begin,
+                        size_t end)
+{
+    end = std::min(end, individuals.size());
+    const auto rows = end > begin ? end - begin : 0;
 
-    const auto firstChildTransform = [&alpha](const double parent1, const double parent2) {
-        return (alpha * parent1) + ((1 - alpha) * parent2);
-    };
+    if (individuals.type() == Individual::Type::GrayCode) {
+        if (type != MutationType::BitFlip) {
+            return false;
+        }
 
-    const auto secondChildTransform = [&alpha](const double parent1, const double parent2) {
-        return ((1 - alpha) * parent1) + (alpha * parent2);
-    };
+        GeneticOperators::sparseFlip(
+            rows, individuals.dimentions() * individuals.bitsPerGene(), rate, m_random,
+            [&](const size_t row) { return individuals.codes(begin + row); },
+            [&](const size_t row) { individuals.setDirty(begin + row, true); });
 
-    const auto transform = [](const auto& parent1, const auto& parent2, auto& destination, const auto func) {
-        const auto& parent1Vec = std::get<Individual::Gene>(parent1.chromosomes());
-        const auto& parent2Vec = std::get<Individual::Gene>(parent2.chromosomes());
-        std::ranges::transform(parent1Vec, parent2Vec, std::back_inserter(destination), func);
-    };
+        return true;
+    }
 
-    auto& child1Vec = std::get<Individual::Gene>(child1Chromosomes);
-    auto& child2Vec = std::get<Individual::Gene>(child2Chromosomes);
+    return GeneticOperators::sparseMutate(
+        type, rows, individuals.dimentions(), rate, m_bounds, m_random,
+        [&](const size_t row, const size_t at) { return individuals.gene(begin + row, at); },
+        [&](const size_t row, const size_t at, const double value) {
+            individuals.setGene(begin + row, at, value);
+            individuals.setDirty(begin + row, true);
+        });
+}
 
-    transform(parent1, parent2, child1Vec, firstChildTransform);
-    transform(parent2, parent1, child2Vec, secondChildTransform);
+void Population::invalidateFitness()
+{
+    m_individuals.setAllDirty();
+}
 
-    Individual child1 = std::move(parent1);
-    Individual child2 = std::move(parent2);
+void Population::setFitnessCache(const size_t capacity)
+{
+    m_evaluator.setCacheCapacity(capacity);
+}
 
-    child1.setChromosomes(child1Chromosomes);
-    child2.setChromosomes(child2Chromosomes);
+void Population::setSurrogate(const double fraction, const size_t neighbours, const size_t archive)
+{
+    m_evaluator.setSurrogate(fraction, neighbours, archive);
+}
 
-    return std::make_pair(child1, child2);
+const FitnessEvaluator& Population::evaluator() const
+{
+    return m_evaluator;
 }
 
-Population::CrossoverResult Population::twoPointCrossover(const Individual& parent1, const Individual& parent2)
+size_t Population::best() const
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(1, 6);
+    return Selection::best(m_individuals);
+}
 
-    auto point1 = dist(gen);
-    auto point2 = dist(gen);
+bool Population::replace(const ReplacementType type, const Individuals& from, const size_t fromIx)
+{
+    const auto victim = Selection::victim(m_individuals.fitnesses(), type, from.fitness(fromIx), m_random);
 
-    if (point1 > point2) {
-        std::swap(point1, point2);
+    if (!victim) {
+        return false;
     }
 
-    std::bitset<8> child1Code, child2Code;
+    m_individuals.copyRow(*victim, from, fromIx);
+    return true;
+}
 
-    const auto& parent1Vec = std::get<Individual::GrayCode>(parent1.chromosomes());
-    const auto& parent2Vec = std::get<Individual::GrayCode>(parent2.chromosomes());
+void Population::emigrate(Individuals& migrants)
+{
+    Selection::emigrate(m_individuals, migrants, m_order);
+}
 
-    for (size_t j = 0; j < parent1Vec.size(); j++) {
-        for (size_t i = 0; i < 8; ++i) {
-            if (i < point1 || i >= point2) {
-                child1Code.set(i, parent1Vec[j].test(i));
-                child2Code.set(i, parent2Vec[j].test(i));
-            } else {
-                child1Code.set(i, parent2Vec[j].test(i));
-                child2Code.set(i, parent1Vec[j].test(i));
-            }
-        }
-    }
+void Population::immigrate(const Individuals& migrants)
+{
+    Selection::immigrate(m_individuals, migrants, m_order);
+}
+
+void Population::adopt(const size_t ix, const Individuals& from, const size_t fromIx)
+{
+    m_individuals.copyRow(ix, from, fromIx);
+}
+
+void Population::countEvaluations(const uint64_t count)
+{
+    m_evaluator.addEvaluations(count);
+}
 
-    Individual child1;
-    child1.append(child1Code);
+Random& Population::random()
+{
+    return m_random;
+}
 
-    Individual child2;
-    child2.append(child2Code);
+Population::Individuals& Population::offspring()
+{
+    return m_offspring;
+}
 
-    return std::make_pair(child1, child2);
+void Population::swapGenerations()
+{
+    std::swap(m_individuals, m_offspring);
 }
 
 size_t Population::size() const
@@ -269,8 +289,12 @@ size_t Population::size() const
     return m_individuals.size();
 }
 
-void Population::setIndividuals(const Individuals& inds)
+void Population::setIndividuals(Individuals&& inds)
 {
+    if (!m_individuals.sameShape(inds)) {
+        allocateGenerations(inds.size(), inds.dimentions(), inds.type(), inds.bitsPerGene(), inds.precision());
+    }
+
     m_individuals = std::move(inds);
 }
 
@@ -279,6 +303,11 @@ const Population::Individuals& Population::individuals() const
     return m_individuals;
 }
 
+const Population::Bounds& Population::bounds() const
+{
+    return m_bounds;
+}
+
 std::string Population::toString() const
 {
     std::stringstream oss;
@@ -286,7 +315,7 @@ std::string Population::toString() const
     oss << "[";
 
     for (size_t i = 0; i < m_individuals.size(); ++i) {
-        oss << m_individuals[i].toString();
+        oss << m_individuals.toString(i);
         if (i < m_individuals.size() - 1) {
             oss << ", ";
         }
@@ -295,3 +324,23 @@ std::string Population::toString() const
 
     return oss.str();
 }
+
+void Population::allocateGenerations(const size_t size, const size_t dimentions, const Individual::Type type,
+                                     const uint8_t bitsPerGene, const GenePrecision precision)
+{
+    //! Both generations in one block, with some slack for alignment padding.
+    const auto bytes = 2 * GenePool::footprint(size, dimentions, type, bitsPerGene, precision) + 256;
+
+    auto arena = std::make_unique<std::pmr::monotonic_buffer_resource>(bytes);
+    Individuals individuals(size, dimentions, type, bitsPerGene, arena.get(), precision, m_bounds);
+    Individuals offspring(size, dimentions, type, bitsPerGene, arena.get(), precision, m_bounds);
+
+    //! pmr containers keep their resource on assignment, only a move construction hands
+    //! the arena-backed storage over, so the buffers are rebuilt in place.
+    std::destroy_at(&m_individuals);
+    std::construct_at(&m_individuals, std::move(individuals));
+    std::destroy_at(&m_offspring);
+    std::construct_at(&m_offspring, std::move(offspring));
+
+    m_arena = std::move(arena);
+}
@@ -1,19 +1,32 @@
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <optional>
 #include <algorithm>
 #include <iterator>
+#include <memory>
+#include <memory_resource>
 
-#include "individual.h"
+#include "genepool.h"
+#include "selection.h"
+#include "threadpool.h"
+#include "fitnessevaluator.h"
 
 class Population final
 {
 public:
     using Bounds = std::pair<double, double>;
-    using Individuals = std::vector<Individual>;
-    using CrossoverResult = std::pair<Individual, Individual>;
+    using Individuals = GenePool;
+    //! Selected parents, as row indices into the current individuals.
+    using Parents = Selection::Parents;
+    using GeneRow = std::span<double>;
+    using ConstGeneRow = std::span<const double>;
+    using CodeRow = std::span<GenePool::Code>;
+    using ConstCodeRow = std::span<const GenePool::Code>;
+    using GenePrecision = GenePool::Precision;
 
     enum class IndividualType
     {
@@ -22,14 +35,9 @@ public:
         GrayCode
     };
 
-    enum class SelectionType
-    {
-        None = 0,
-        Tournament,
-        Rank,
-        Panmixia,
-        Proportional
-    };
+    using SelectionType = Selection::Scheme;
+
+    using SamplingType = Selection::Sampling;
 
     enum class CrossoverType
     {
@@ -39,68 +47,136 @@ public:
         TwoPoint
     };
 
-    Population(const uint32_t size = 10, const uint8_t dimenions = 1, const IndividualType individualType = IndividualType::None,
-               const Bounds& bounds = std::make_pair(-1.0, 1.0));
+    //! Per-gene mutation of the sparse pass, see GeneticOperators::Mutation.
+    using MutationType = GeneticOperators::Mutation;
 
-    //! Selections
-    std::optional<Individuals> selection(const SelectionType selectionType);
-    Individuals tournamentSelection(const uint32_t tournamentSize = 3);
-    Individuals rankSelection();
-    Individuals panmixiaSelection();
-    Individuals proportionalSelection();
+    //! Which individual a steady-state child takes the place of, see Selection::Replacement.
+    using ReplacementType = Selection::Replacement;
+
+    //! \a precision is how real genes are stored, see GenePool::Precision; operators and
+    //! fitness functions work on doubles either way.
+    Population(const uint32_t size = 10, const size_t dimentions = 1, const IndividualType individualType = IndividualType::None,
+               const Bounds& bounds = std::make_pair(-1.0, 1.0), const uint8_t bitsPerGene = 8,
+               const Random& random = Random{}, const GenePrecision precision = GenePrecision::Double);
 
+    //! Selections
+    //! Each one fills \a parents with size() indices, reusing its capacity. \a sampling
+    //! applies to the weighted schemes: ranks and proportional.
+    bool selection(const SelectionType selectionType, Parents& parents, const SamplingType sampling = SamplingType::Roulette);
+    void tournamentSelection(Parents& parents, const uint32_t tournamentSize = 3);
+    void rankSelection(Parents& parents, const SamplingType sampling = SamplingType::Roulette);
+    void exponentialRankSelection(Parents& parents, const SamplingType sampling = SamplingType::Roulette);
+    void panmixiaSelection(Parents& parents);
+    void proportionalSelection(Parents& parents, const SamplingType sampling = SamplingType::Roulette);
+
+    //! Parents one at a time, for breeding a pair at a time, see Selection::prepare and
+    //! Selection::draw.
+    bool prepareSelection(const SelectionType selectionType, const SamplingType sampling = SamplingType::Roulette);
+    uint32_t drawParent();
+
+    //! \a f is either called per individual with its genes or, when it takes
+    //! (const GeneTile&, std::span<double>), with whole tiles of rows.
     template<class Func>
     void updateFitness(Func f)
-    {        
-        for (auto& ind : m_individuals) {
-            const auto fitness = [f, &ind]() {
-                const auto arg = ind.chromosomes();
-
-                if (std::holds_alternative<Individual::Gene>(arg)) {
-                    return f(std::get<Individual::Gene>(arg));
-                } else if (std::holds_alternative<Individual::GrayCode>(arg)){
-                    const auto& argVec = std::get<Individual::GrayCode>(arg);
-
-                    const auto intValue = [](const std::bitset<8> argVal) -> double {
-                        std::bitset<8> binary;
-                        binary[7] = argVal[7];
-
-                        for (int i = 6; i >= 0; --i) {
-                            binary[i] = binary[i + 1] ^ argVal[i];
-                        }
-
-                        return static_cast<double>(binary.to_ulong());
-                    };
-
-                    std::vector<double> functionInput;
-                    functionInput.resize(argVec.size());
-
-                    std::ranges::transform(argVec, std::back_inserter(functionInput), [&intValue](const auto value) {
-                        return intValue(value);
-                    });
-
-                    return f(functionInput);
-                }
+    {
+        m_evaluator.update(m_individuals, f, m_bounds);
+    }
 
-                return 0.0;
-            }();
+    //! Parallel version of the above, see FitnessEvaluator.
+    template<class Func>
+    void updateFitness(const Func& f, ThreadPool& pool)
+    {
+        m_evaluator.update(m_individuals, f, m_bounds, pool);
+    }
 
-            ind.setFitness(fitness);
-        }
+    //! Evaluates row \a ix of \a individuals (the offspring) right away, if dirty, while
+    //! it is still in cache. See FitnessEvaluator::updateRow.
+    template<class Func>
+    void updateFitness(Individuals& individuals, const size_t ix, const Func& f)
+    {
+        m_evaluator.updateRow(individuals, ix, f, m_bounds);
     }
 
+    //! Only dirty individuals are evaluated, call this before switching to another fitness function.
+    void invalidateFitness();
+    //! Genome -> fitness cache of \a capacity entries, 0 (the default) turns it off.
+    void setFitnessCache(const size_t capacity);
+    //! Surrogate pre-screening of changed individuals, see FitnessEvaluator::setSurrogate.
+    void setSurrogate(const double fraction, const size_t neighbours, const size_t archive = KdTree::DefaultCapacity);
+    const FitnessEvaluator& evaluator() const;
+
     //! Crossovers
-    std::optional<CrossoverResult> crossover(const CrossoverType type, const Individual& parent1, const Individual& parent2);
-    CrossoverResult discreteCrossover(const Individual& parent1, const Individual& parent2);
-    CrossoverResult linearCrossover(const Individual& parent1, const Individual& parent2);
-    CrossoverResult twoPointCrossover(const Individual& parent1, const Individual& parent2);
+    //! Parents are read in place from the current individuals, children are written straight
+    //! into rows \a child and \a child + 1 of \a children. The second child is dropped when it
+    //! falls past the end of an odd-sized generation. A child identical to one of its parents
+    //! inherits its fitness and stays clean, any other is marked dirty.
+    bool crossover(const CrossoverType type, const size_t parent1, const size_t parent2,
+                   Individuals& children, const size_t child);
+    //! An empty child row is skipped.
+    void discreteCrossover(ConstGeneRow parent1, ConstGeneRow parent2, GeneRow child1, GeneRow child2);
+    void linearCrossover(ConstGeneRow parent1, ConstGeneRow parent2, GeneRow child1, GeneRow child2);
+    void twoPointCrossover(ConstCodeRow parent1, ConstCodeRow parent2, CodeRow child1, CodeRow child2);
+
+    //! Mutates row \a ix of \a individuals in place: real genes are reset within the population
+    //! bounds, packed Gray rows get a single bit flipped.
+    void mutate(Individuals& individuals, const size_t ix, const double probability);
+    //! Sparse pass over rows [begin, end) of \a individuals, all of them by default: every
+    //! gene (every bit for Gray genomes) mutates independently with probability \a rate.
+    //! Only the genes that mutate cost anything, see GeneticOperators::sparseTrials.
+    //! Mutated rows are marked dirty. Fails when \a type does not fit the encoding.
+    bool mutate(Individuals& individuals, const MutationType type, const double rate, const size_t begin = 0,
+                const size_t end = SIZE_MAX);
+
+    //! Index of the individual with the lowest fitness, among the evaluated ones if any.
+    size_t best() const;
+
+    //! Steady state: lets row \a fromIx of \a from (evaluated) replace an individual chosen
+    //! by \a type. Returns whether it got in.
+    bool replace(const ReplacementType type, const Individuals& from, const size_t fromIx);
+
+    //! Island migration: copies the migrants.size() fittest individuals into \a migrants,
+    //! or lets \a migrants replace as many of the weakest ones, fitness included.
+    void emigrate(Individuals& migrants);
+    void immigrate(const Individuals& migrants);
+
+    //! Memetic stage: row \a ix takes row \a fromIx of \a from, fitness included, as found
+    //! by a local search. Its fitness calls, made outside evaluator(), are counted by
+    //! countEvaluations().
+    void adopt(const size_t ix, const Individuals& from, const size_t fromIx);
+    void countEvaluations(const uint64_t count);
+
+    //! Generations are double-buffered: crossover and mutation write the next one into
+    //! offspring(), swapGenerations() then makes it current. Both buffers are carved out
+    //! of one arena allocated up front, so an epoch does not touch the heap.
+    Individuals& offspring();
+    void swapGenerations();
+
+    //! The population's own stream, every operator above draws from it.
+    Random& random();
 
     size_t size() const;
-    void setIndividuals(const Individuals& inds);
+    //! Copies into the current buffer when the shape matches, reallocates both buffers otherwise.
+    void setIndividuals(Individuals&& inds);
     const Individuals& individuals() const;
+    const Bounds& bounds() const;
     std::string toString() const;
 
 private:
+    //! Real crossover of rows stored below double precision: the parents are widened a
+    //! block at a time into m_widened, crossed there and the children narrowed back.
+    void crossWidened(const CrossoverType type, const size_t parent1, const size_t parent2, Individuals& children,
+                      const size_t child, const bool hasSecond);
+    void allocateGenerations(const size_t size, const size_t dimentions, const Individual::Type type,
+                             const uint8_t bitsPerGene, const GenePrecision precision);
+
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> m_arena;
     Individuals m_individuals;
+    Individuals m_offspring;
+    Selection::Scratch m_selection;
+    Parents m_order;
+    std::vector<double> m_widened;
+    FitnessEvaluator m_evaluator;
     IndividualType m_type;
+    Bounds m_bounds;
+    Random m_random;
 };
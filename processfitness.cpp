@@ -0,0 +1,494 @@
+#include "processfitness.h"
+
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+
+namespace
+{
+
+#ifdef MSG_NOSIGNAL
+constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+constexpr int SendFlags = 0;
+#endif
+
+//! One sequence number, retrying on interrupts. False on EOF or error.
+bool receive(const int fd, uint64_t& value)
+{
+    auto* out = reinterpret_cast<char*>(&value);
+    size_t done = 0;
+
+    while (done < sizeof(value)) {
+        const auto n = ::read(fd, out + done, sizeof(value) - done);
+
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+        } else if (n == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool send(const int fd, const uint64_t value, const bool socket)
+{
+    const auto* in = reinterpret_cast<const char*>(&value);
+    size_t done = 0;
+
+    while (done < sizeof(value)) {
+        const auto n = socket ? ::send(fd, in + done, sizeof(value) - done, SendFlags)
+                              : ::write(fd, in + done, sizeof(value) - done);
+
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+        } else if (n == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+class ProcessFitness::Pool final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Pool(Settings settings)
+        : m_settings{std::move(settings)}
+    {
+        if (m_settings.command.empty()) {
+            throw std::runtime_error("No worker command");
+        }
+
+        if (m_settings.slotBytes < sizeof(SlotHeader) + 2 * sizeof(double)) {
+            throw std::runtime_error("Worker slots too small");
+        }
+
+        //! Prepared up front, the child of a fork only gets to call execvp.
+        for (auto& arg : m_settings.command) {
+            m_argv.push_back(arg.data());
+        }
+
+        m_argv.push_back(nullptr);
+        m_workers.resize(std::max<size_t>(m_settings.workers, 1));
+
+        try {
+            for (auto& worker : m_workers) {
+                map(worker);
+                start(worker);
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~Pool() { release(); }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    size_t workers() const { return m_workers.size(); }
+    uint64_t restarts() const { return m_restarts.load(std::memory_order_relaxed); }
+
+    void evaluate(const GeneTile& tile, std::span<double> fitness)
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (tile.rows == 0) {
+            return;
+        }
+
+        const auto rowBytes = (tile.dimentions + 1) * sizeof(double);
+        const auto slotRows = (m_settings.slotBytes - sizeof(SlotHeader)) / rowBytes;
+
+        if (slotRows == 0) {
+            throw std::runtime_error("Genomes too long for the worker slots");
+        }
+
+        //! Small tiles still go to every worker.
+        const auto chunkRows = std::clamp<size_t>((tile.rows + m_workers.size() - 1) / m_workers.size(), 1, slotRows);
+
+        m_chunks.clear();
+
+        for (size_t begin = 0; begin < tile.rows; begin += chunkRows) {
+            m_chunks.push_back({begin, std::min(chunkRows, tile.rows - begin), 0});
+        }
+
+        try {
+            dispatch(tile, fitness);
+        } catch (...) {
+            //! Busy workers may still write their slots, they start over.
+            for (auto& worker : m_workers) {
+                if (worker.busy) {
+                    worker.busy = false;
+                    restart(worker);
+                }
+            }
+
+            throw;
+        }
+    }
+
+private:
+    struct Chunk
+    {
+        size_t begin;
+        size_t rows;
+        uint32_t attempts;
+    };
+
+    struct Worker
+    {
+        pid_t pid = -1;
+        int channel = -1;
+        int slotFd = -1;
+        std::byte* slot = nullptr;
+        bool busy = false;
+        Chunk chunk{};
+        uint64_t sequence = 0;
+        Clock::time_point deadline;
+    };
+
+    void dispatch(const GeneTile& tile, std::span<double> fitness)
+    {
+        size_t busy = 0;
+
+        while (!m_chunks.empty() || busy > 0) {
+            for (auto& worker : m_workers) {
+                while (!worker.busy && !m_chunks.empty()) {
+                    auto chunk = m_chunks.back();
+                    m_chunks.pop_back();
+
+                    if (post(worker, tile, chunk)) {
+                        ++busy;
+                    } else {
+                        retry(worker, chunk);
+                    }
+                }
+            }
+
+            m_polls.clear();
+
+            auto wait = Clock::duration::max();
+            const auto now = Clock::now();
+
+            for (const auto& worker : m_workers) {
+                if (worker.busy) {
+                    m_polls.push_back({worker.channel, POLLIN, 0});
+                    wait = std::min(wait, worker.deadline - now);
+                }
+            }
+
+            if (m_polls.empty()) {
+                continue;
+            }
+
+            const auto ms = std::chrono::ceil<std::chrono::milliseconds>(std::max(wait, Clock::duration::zero()));
+
+            if (::poll(m_polls.data(), m_polls.size(), static_cast<int>(std::min<int64_t>(ms.count(), 1 << 30))) < 0
+                && errno != EINTR) {
+                throw std::runtime_error("Failed to wait for workers");
+            }
+
+            const auto polled = Clock::now();
+
+            for (auto& worker : m_workers) {
+                if (!worker.busy) {
+                    continue;
+                }
+
+                const auto ready = std::ranges::find(m_polls, worker.channel, &pollfd::fd)->revents != 0;
+
+                if (!ready && polled < worker.deadline) {
+                    continue;
+                }
+
+                uint64_t sequence = 0;
+
+                worker.busy = false;
+                --busy;
+
+                if (ready && receive(worker.channel, sequence) && sequence == worker.sequence) {
+                    const auto* results = worker.slot + sizeof(SlotHeader) + worker.chunk.rows * tile.dimentions * sizeof(double);
+                    std::memcpy(fitness.data() + worker.chunk.begin, results, worker.chunk.rows * sizeof(double));
+                } else {
+                    retry(worker, worker.chunk);
+                }
+            }
+        }
+    }
+
+    //! Copies \a chunk into the worker's slot and wakes it up.
+    bool post(Worker& worker, const GeneTile& tile, const Chunk& chunk)
+    {
+        if (worker.pid < 0) {
+            start(worker);
+        }
+
+        const SlotHeader header{++m_sequence, chunk.rows, tile.dimentions, m_settings.slotBytes};
+        const auto genes = tile.genes.subspan(chunk.begin * tile.dimentions, chunk.rows * tile.dimentions);
+
+        std::memcpy(worker.slot, &header, sizeof(header));
+        std::memcpy(worker.slot + sizeof(header), genes.data(), genes.size_bytes());
+
+        worker.chunk = chunk;
+        worker.sequence = header.sequence;
+        worker.deadline = Clock::now() + m_settings.timeout;
+        worker.busy = send(worker.channel, header.sequence, true);
+
+        return worker.busy;
+    }
+
+    //! Replaces a worker that failed on \a chunk and queues the chunk again.
+    void retry(Worker& worker, Chunk chunk)
+    {
+        restart(worker);
+
+        if (++chunk.attempts > m_settings.retries) {
+            throw std::runtime_error("Worker failed on a batch " + std::to_string(chunk.attempts) + " times");
+        }
+
+        m_chunks.push_back(chunk);
+    }
+
+    void restart(Worker& worker)
+    {
+        stop(worker, false);
+        start(worker);
+        m_restarts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void map(Worker& worker)
+    {
+        static std::atomic<uint64_t> slots = 0;
+        const auto name = "/genetic_algo." + std::to_string(::getpid()) + "." + std::to_string(slots++);
+
+        worker.slotFd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+        if (worker.slotFd < 0) {
+            throw std::runtime_error("Failed to create shared memory " + name);
+        }
+
+        //! The descriptor is all the workers need.
+        ::shm_unlink(name.c_str());
+        ::fcntl(worker.slotFd, F_SETFD, FD_CLOEXEC);
+
+        if (::ftruncate(worker.slotFd, static_cast<off_t>(m_settings.slotBytes)) != 0) {
+            throw std::runtime_error("Failed to size shared memory " + name);
+        }
+
+        void* slot = ::mmap(nullptr, m_settings.slotBytes, PROT_READ | PROT_WRITE, MAP_SHARED, worker.slotFd, 0);
+
+        if (slot == MAP_FAILED) {
+            throw std::runtime_error("Failed to map shared memory " + name);
+        }
+
+        worker.slot = static_cast<std::byte*>(slot);
+    }
+
+    void start(Worker& worker)
+    {
+        int channel[2];
+
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, channel) != 0) {
+            throw std::runtime_error("Failed to create a worker channel");
+        }
+
+        ::fcntl(channel[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(channel[1], F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+        const int on = 1;
+        ::setsockopt(channel[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+        const auto pid = ::fork();
+
+        if (pid < 0) {
+            ::close(channel[0]);
+            ::close(channel[1]);
+            throw std::runtime_error("Failed to start a worker");
+        }
+
+        if (pid == 0) {
+            //! Moved out of the way first, either may sit on the other's target.
+            const int slot = ::fcntl(worker.slotFd, F_DUPFD_CLOEXEC, ChannelFd + 1);
+            const int peer = ::fcntl(channel[1], F_DUPFD_CLOEXEC, ChannelFd + 1);
+
+            if (slot >= 0 && peer >= 0 && ::dup2(slot, SlotFd) >= 0 && ::dup2(peer, ChannelFd) >= 0) {
+                ::execvp(m_argv.front(), m_argv.data());
+            }
+
+            ::_exit(127);
+        }
+
+        ::close(channel[1]);
+        worker.pid = pid;
+        worker.channel = channel[0];
+    }
+
+    //! Closing the channel asks a worker to exit, \a graceful gives it a second to.
+    void stop(Worker& worker, const bool graceful)
+    {
+        if (worker.channel >= 0) {
+            ::close(worker.channel);
+            worker.channel = -1;
+        }
+
+        if (worker.pid < 0) {
+            return;
+        }
+
+        for (int i = 0; graceful && i < 100; ++i) {
+            if (::waitpid(worker.pid, nullptr, WNOHANG) == worker.pid) {
+                worker.pid = -1;
+                return;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        ::kill(worker.pid, SIGKILL);
+        ::waitpid(worker.pid, nullptr, 0);
+        worker.pid = -1;
+    }
+
+    void release()
+    {
+        for (auto& worker : m_workers) {
+            stop(worker, true);
+
+            if (worker.slot) {
+                ::munmap(worker.slot, m_settings.slotBytes);
+                worker.slot = nullptr;
+            }
+
+            if (worker.slotFd >= 0) {
+                ::close(worker.slotFd);
+                worker.slotFd = -1;
+            }
+        }
+    }
+
+    Settings m_settings;
+    std::vector<char*> m_argv;
+    std::vector<Worker> m_workers;
+    std::vector<Chunk> m_chunks;
+    std::vector<pollfd> m_polls;
+    std::mutex m_mutex;
+    uint64_t m_sequence = 0;
+    std::atomic<uint64_t> m_restarts = 0;
+};
+
+ProcessFitness::ProcessFitness(Settings settings)
+    : m_pool{std::make_shared<Pool>(std::move(settings))}
+{
+}
+
+void ProcessFitness::operator()(const GeneTile& tile, std::span<double> fitness) const
+{
+    m_pool->evaluate(tile, fitness);
+}
+
+size_t ProcessFitness::workers() const
+{
+    return m_pool->workers();
+}
+
+uint64_t ProcessFitness::restarts() const
+{
+    return m_pool->restarts();
+}
+
+int ProcessFitness::serve(Serve f, const void* context)
+{
+    struct stat status;
+
+    if (::fstat(SlotFd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(SlotHeader)) {
+        return 1;
+    }
+
+    const auto bytes = static_cast<size_t>(status.st_size);
+    void* mapped = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, SlotFd, 0);
+
+    if (mapped == MAP_FAILED) {
+        return 1;
+    }
+
+    auto* slot = static_cast<std::byte*>(mapped);
+    uint64_t sequence = 0;
+    int result = 0;
+
+    while (receive(ChannelFd, sequence)) {
+        SlotHeader header;
+        std::memcpy(&header, slot, sizeof(header));
+
+        if (header.sequence != sequence || header.rows * (header.dimentions + 1) * sizeof(double) > bytes - sizeof(header)) {
+            result = 1;
+            break;
+        }
+
+        auto* genes = reinterpret_cast<const double*>(slot + sizeof(header));
+        auto* fitness = reinterpret_cast<double*>(slot + sizeof(header)) + header.rows * header.dimentions;
+
+        f(context, GeneTile{{genes, header.rows * header.dimentions}, header.rows, header.dimentions},
+          {fitness, header.rows});
+
+        if (!send(ChannelFd, sequence, false)) {
+            result = 1;
+            break;
+        }
+    }
+
+    ::munmap(mapped, bytes);
+
+    return result;
+}
+#else
+class ProcessFitness::Pool final
+{
+};
+
+ProcessFitness::ProcessFitness(Settings)
+{
+    throw std::runtime_error("Worker processes are not supported on this platform");
+}
+
+void ProcessFitness::operator()(const GeneTile&, std::span<double>) const
+{
+}
+
+size_t ProcessFitness::workers() const
+{
+    return 0;
+}
+
+uint64_t ProcessFitness::restarts() const
+{
+    return 0;
+}
+
+int ProcessFitness::serve(Serve, const void*)
+{
+    return 1;
+}
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <span>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+#include "genepool.h"
+
+//! Batch fitness function evaluated by separate worker processes, for simulators that
+//! cannot be linked into the GA. Each of settings.workers processes is started with
+//! settings.command and gets its own shared memory slot: a tile is split into chunks
+//! that fit the slots, the genes are copied in as raw doubles and the fitness read
+//! back from the same slot, nothing is ever formatted as text. A socket pair per
+//! worker carries one sequence number each way per chunk and doubles as a crash
+//! detector, a worker that dies closes its end.
+//!
+//! A worker that crashes or takes longer than settings.timeout on a chunk is killed,
+//! restarted and sent the chunk again, at most settings.retries times; past that the
+//! call throws std::runtime_error. Copies share the same workers and batches are
+//! evaluated one at a time, so with the worker processes being the parallelism, run
+//! the GA with threads = 1. POSIX only, the constructor throws elsewhere.
+//!
+//! The worker binary calls serve() with its fitness function, see worker.cpp.
+class ProcessFitness final
+{
+public:
+    struct Settings
+    {
+        //! Executable and arguments of a worker, looked up in PATH like execvp.
+        std::vector<std::string> command;
+        size_t workers = std::thread::hardware_concurrency();
+        //! Longest a worker may take on one chunk.
+        std::chrono::milliseconds timeout{10000};
+        //! Restarts per chunk before giving up on it.
+        uint32_t retries = 2;
+        //! Shared memory per worker; a chunk is as many rows as fit.
+        size_t slotBytes = size_t{1} << 22;
+    };
+
+    //! Shared memory and channel descriptors a worker inherits.
+    static constexpr int SlotFd = 3;
+    static constexpr int ChannelFd = 4;
+
+    explicit ProcessFitness(Settings settings);
+
+    void operator()(const GeneTile& tile, std::span<double> fitness) const;
+
+    size_t workers() const;
+    //! Workers restarted so far, after crashes and timeouts.
+    uint64_t restarts() const;
+
+    //! Worker side: answers the chunks the GA process sends until it closes the
+    //! channel, then returns 0. \a f is a batch or per individual fitness function.
+    //! Returns nonzero when not started by a ProcessFitness.
+    template<class Func>
+    static int serve(const Func& f)
+    {
+        return serve(
+            [](const void* context, const GeneTile& tile, std::span<double> fitness) {
+                const auto& func = *static_cast<const Func*>(context);
+
+                if constexpr (std::is_invocable_v<const Func&, const GeneTile&, std::span<double>>) {
+                    func(tile, fitness);
+                } else {
+                    for (size_t i = 0; i < tile.rows; ++i) {
+                        fitness[i] = func(tile.row(i));
+                    }
+                }
+            },
+            &f);
+    }
+
+private:
+    using Serve = void (*)(const void*, const GeneTile&, std::span<double>);
+
+    //! Start of every slot, the genes follow it and the fitness follows the genes.
+    struct SlotHeader
+    {
+        uint64_t sequence;
+        uint64_t rows;
+        uint64_t dimentions;
+        uint64_t bytes;
+    };
+
+    class Pool;
+
+    static int serve(Serve f, const void* context);
+
+    std::shared_ptr<Pool> m_pool;
+};
@@ -0,0 +1,181 @@
+#include "random.h"
+
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+
+namespace
+{
+constexpr uint32_t PhiloxM0 = 0xD2511F53;
+constexpr uint32_t PhiloxM1 = 0xCD9E8D57;
+constexpr uint32_t PhiloxW0 = 0x9E3779B9;
+constexpr uint32_t PhiloxW1 = 0xBB67AE85;
+constexpr int PhiloxRounds = 10;
+
+double toUnit(const uint64_t bits)
+{
+    return (bits >> 11) * 0x1.0p-53;
+}
+}
+
+Random::Random(const uint64_t seed, const uint64_t stream)
+    : m_seed{seed}
+    , m_stream{stream}
+{}
+
+Random::Random(const State& state)
+    : m_seed{state.seed}
+    , m_stream{state.stream}
+    , m_block{state.block}
+    , m_position{std::min<uint8_t>(state.position, 4)}
+    , m_hasSpare{state.hasSpare}
+    , m_spare{state.spare}
+{
+    //! The buffered block is the last one generated, a pure function of the counter.
+    if (m_position < 4 && m_block > 0) {
+        m_buffer = generate(m_block - 1);
+    }
+}
+
+Random Random::split(const uint64_t stream) const
+{
+    return Random(m_seed, stream);
+}
+
+Random::result_type Random::operator()()
+{
+    if (m_position == 4) {
+        refill();
+    }
+
+    return m_buffer[m_position++];
+}
+
+uint64_t Random::next64()
+{
+    const uint64_t hi = (*this)();
+    return (hi << 32) | (*this)();
+}
+
+double Random::uniform()
+{
+    return toUnit(next64());
+}
+
+double Random::uniform(const double from, const double to)
+{
+    return from + uniform() * (to - from);
+}
+
+uint64_t Random::index(const uint64_t n)
+{
+    //! Lemire's multiply-shift with rejection, exact and almost always division free.
+    if (n <= max()) {
+        uint64_t product = uint64_t{(*this)()} * n;
+        auto low = static_cast<uint32_t>(product);
+
+        if (low < n) {
+            const auto threshold = static_cast<uint32_t>(-static_cast<uint32_t>(n) % static_cast<uint32_t>(n));
+
+            while (low < threshold) {
+                product = uint64_t{(*this)()} * n;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+
+        return product >> 32;
+    }
+
+    const auto limit = std::numeric_limits<uint64_t>::max() - std::numeric_limits<uint64_t>::max() % n;
+    uint64_t value;
+
+    do {
+        value = next64();
+    } while (value >= limit);
+
+    return value % n;
+}
+
+double Random::normal()
+{
+    if (m_hasSpare) {
+        m_hasSpare = false;
+        return m_spare;
+    }
+
+    const auto u1 = 1.0 - uniform();
+    const auto u2 = uniform();
+    const auto radius = std::sqrt(-2.0 * std::log(u1));
+    const auto angle = 2.0 * std::numbers::pi * u2;
+
+    m_spare = radius * std::sin(angle);
+    m_hasSpare = true;
+
+    return radius * std::cos(angle);
+}
+
+void Random::fill(std::span<uint32_t> out)
+{
+    size_t i = 0;
+
+    while (i < out.size() && m_position < 4) {
+        out[i++] = m_buffer[m_position++];
+    }
+
+    for (; i + 4 <= out.size(); i += 4) {
+        const auto block = generate(m_block++);
+        std::copy(block.begin(), block.end(), out.begin() + i);
+    }
+
+    while (i < out.size()) {
+        out[i++] = (*this)();
+    }
+}
+
+void Random::fill(std::span<double> out)
+{
+    for (auto& value : out) {
+        value = uniform();
+    }
+}
+
+uint64_t Random::seed() const
+{
+    return m_seed;
+}
+
+uint64_t Random::stream() const
+{
+    return m_stream;
+}
+
+Random::State Random::state() const
+{
+    return State{m_seed, m_stream, m_block, m_spare, m_position, m_hasSpare};
+}
+
+Random::Block Random::generate(const uint64_t block) const
+{
+    Block counter = {static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32),
+                     static_cast<uint32_t>(m_stream), static_cast<uint32_t>(m_stream >> 32)};
+    std::array<uint32_t, 2> key = {static_cast<uint32_t>(m_seed), static_cast<uint32_t>(m_seed >> 32)};
+
+    for (int round = 0; round < PhiloxRounds; ++round) {
+        const uint64_t product0 = uint64_t{PhiloxM0} * counter[0];
+        const uint64_t product1 = uint64_t{PhiloxM1} * counter[2];
+
+        counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                   static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)};
+
+        key[0] += PhiloxW0;
+        key[1] += PhiloxW1;
+    }
+
+    return counter;
+}
+
+void Random::refill()
+{
+    m_buffer = generate(m_block++);
+    m_position = 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <limits>
+#include <cstdint>
+
+//! Counter-based Philox4x32-10 generator. The output is a pure function of
+//! (seed, stream, position), so independent streams are free to create and a
+//! run is reproduced exactly from its seed. Satisfies UniformRandomBitGenerator,
+//! so it can also drive the std distributions.
+class Random final
+{
+public:
+    using result_type = uint32_t;
+
+    //! Position within the sequence, enough to continue it in another process.
+    struct State
+    {
+        uint64_t seed = 0;
+        uint64_t stream = 0;
+        uint64_t block = 0;
+        double spare = 0.0;
+        uint8_t position = 4;
+        bool hasSpare = false;
+    };
+
+    Random(const uint64_t seed = 0, const uint64_t stream = 0);
+    explicit Random(const State& state);
+
+    //! Independent generator for \a stream under the same seed. Derive streams from
+    //! the work item (individual, island, run), never from the thread that runs it,
+    //! and results do not depend on the thread count.
+    Random split(const uint64_t stream) const;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+    result_type operator()();
+
+    uint64_t next64();
+    //! Uniform in [0, 1).
+    double uniform();
+    double uniform(const double from, const double to);
+    //! Uniform integer in [0, n), n > 0.
+    uint64_t index(const uint64_t n);
+    //! Standard normal deviate.
+    double normal();
+
+    //! Batched draws, one Philox block per four words.
+    void fill(std::span<uint32_t> out);
+    void fill(std::span<double> out);
+
+    uint64_t seed() const;
+    uint64_t stream() const;
+    State state() const;
+
+private:
+    using Block = std::array<uint32_t, 4>;
+
+    Block generate(const uint64_t block) const;
+    void refill();
+
+    uint64_t m_seed;
+    uint64_t m_stream;
+    uint64_t m_block = 0;
+    Block m_buffer{};
+    uint8_t m_position = 4;
+    bool m_hasSpare = false;
+    double m_spare = 0.0;
+};
@@ -0,0 +1,141 @@
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include <filesystem>
+
+#include "geneticalgo.h"
+#include "benchmarkfunctions.h"
+
+//! A run checkpointed partway and resumed has to end exactly where the same run ends
+//! uninterrupted: same best genes, same fitness bit for bit.
+
+namespace
+{
+
+constexpr uint64_t Epochs = 120;
+constexpr uint32_t Checkpoint = 50;
+//! Out of reach, so every run goes the distance.
+constexpr double Target = -100.0;
+
+GeneticAlgo::PopulationSettings baseSettings()
+{
+    GeneticAlgo::PopulationSettings settings;
+    settings.size = 20;
+    settings.dimentions = 20;
+    settings.bounds = std::make_pair(0.0, M_PI);
+    settings.type = Population::IndividualType::Discrete;
+    settings.selection = Population::SelectionType::Tournament;
+    settings.crossover = Population::CrossoverType::Linear;
+    settings.mutationChance = 0.2;
+    settings.mutation = Population::MutationType::Gaussian;
+    settings.mutationRate = 0.05;
+    settings.seed = 7;
+
+    return settings;
+}
+
+bool check(const std::string& name, const GeneticAlgo::PopulationSettings& settings,
+           const GeneticAlgo::Termination& termination = {})
+{
+    const Michalewicz michalewicz{.m = 10};
+    const auto path = (std::filesystem::temp_directory_path() / ("genetic_algo_resume_" + name + ".snapshot")).string();
+
+    GeneticAlgo whole(Epochs);
+    whole.setTermination(termination);
+    const auto expected = whole.run(settings, michalewicz, Target);
+
+    GeneticAlgo interrupted(Checkpoint);
+    interrupted.setTermination(termination);
+    interrupted.setCheckpoint(path, Checkpoint);
+    interrupted.run(settings, michalewicz, Target);
+
+    GeneticAlgo resumed(Epochs);
+    resumed.setTermination(termination);
+    const auto actual = resumed.resume(settings, path, michalewicz, Target);
+
+    std::filesystem::remove(path);
+
+    const bool same = expected.fitness() == actual.fitness() && expected.toString() == actual.toString();
+    std::cout << (same ? "ok      " : "FAILED  ") << name << std::endl;
+
+    if (!same) {
+        std::cout << "  uninterrupted: " << expected.toString() << std::endl;
+        std::cout << "  resumed:       " << actual.toString() << std::endl;
+    }
+
+    return same;
+}
+
+//! A checkpoint of \a settings has to be refused by a run of \a other.
+bool rejects(const std::string& name, const GeneticAlgo::PopulationSettings& settings,
+             const GeneticAlgo::PopulationSettings& other)
+{
+    const Michalewicz michalewicz{.m = 10};
+    const auto path = (std::filesystem::temp_directory_path() / ("genetic_algo_resume_" + name + ".snapshot")).string();
+
+    GeneticAlgo interrupted(Checkpoint);
+    interrupted.setCheckpoint(path, Checkpoint);
+    interrupted.run(settings, michalewicz, Target);
+
+    bool rejected = false;
+
+    try {
+        GeneticAlgo(Epochs).resume(other, path, michalewicz, Target);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+
+    std::filesystem::remove(path);
+    std::cout << (rejected ? "ok      " : "FAILED  ") << name << std::endl;
+
+    return rejected;
+}
+
+} // namespace
+
+int main()
+{
+    bool passed = true;
+
+    passed &= check("real", baseSettings());
+
+    auto gray = baseSettings();
+    gray.type = Population::IndividualType::GrayCode;
+    gray.crossover = Population::CrossoverType::TwoPoint;
+    gray.mutation = Population::MutationType::BitFlip;
+    gray.mutationRate = 0.01;
+    gray.bitsPerGene = 16;
+    passed &= check("gray", gray);
+
+    auto fixed = baseSettings();
+    fixed.precision = Population::GenePrecision::Fixed16;
+    passed &= check("fixed16", fixed);
+
+    auto widened = fixed;
+    widened.bounds = std::make_pair(0.0, 4.0);
+    passed &= rejects("fixed16_other_bounds", fixed, widened);
+
+    auto adaptive = baseSettings();
+    adaptive.adaptiveRates = true;
+    adaptive.targetDiversity = 0.05;
+    passed &= check("adaptive", adaptive);
+
+    //! The memetic stage has already run on the restored generation.
+    auto memetic = baseSettings();
+    memetic.localSearch = {.method = LocalSearch::Method::HillClimber, .elites = 2, .evaluations = 30};
+    passed &= check("local_search", memetic);
+
+    //! The budget runs out after the checkpoint, the resumed run has to count the
+    //! evaluations made before it.
+    GeneticAlgo::Termination budget;
+    budget.maxEvaluations = 1200;
+    passed &= check("evaluation_budget", baseSettings(), budget);
+
+    //! Stalls shortly after the checkpoint, counting from an improvement before it.
+    GeneticAlgo::Termination stall;
+    stall.stallEpochs = 20;
+    stall.stallTolerance = 0.3;
+    passed &= check("stall", baseSettings(), stall);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+#include "selection.h"
+
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+
+bool Selection::select(const Scheme scheme, std::span<const double> fitness, Random& random, Parents& parents,
+                       Scratch& scratch, const Sampling sampling)
+{
+    switch (scheme) {
+    case Scheme::None:
+        return false;
+    case Scheme::Tournament:
+        tournament(fitness, random, parents);
+        return true;
+    case Scheme::Rank:
+        rank(fitness, random, parents, scratch, sampling);
+        return true;
+    case Scheme::Panmixia:
+        panmixia(fitness, random, parents);
+        return true;
+    case Scheme::Proportional:
+        proportional(fitness, random, parents, scratch, sampling);
+        return true;
+    case Scheme::ExponentialRank:
+        exponentialRank(fitness, random, parents, scratch, sampling);
+        return true;
+    }
+
+    return false;
+}
+
+bool Selection::prepare(const Scheme scheme, std::span<const double> fitness, Random& random, Scratch& scratch,
+                        const Sampling sampling)
+{
+    scratch.drawScheme = scheme;
+    scratch.drawSampling = sampling;
+    scratch.nextDraw = 0;
+
+    switch (scheme) {
+    case Scheme::None:
+        return false;
+    case Scheme::Tournament:
+    case Scheme::Panmixia:
+        return true;
+    case Scheme::Rank:
+    case Scheme::ExponentialRank:
+    case Scheme::Proportional:
+        if (sampling == Sampling::Universal) {
+            //! select() reuses the rank and alias tables of scratch, not drawn.
+            return select(scheme, fitness, random, scratch.drawn, scratch, sampling);
+        }
+
+        if (scheme == Scheme::Proportional) {
+            prepareProportional(fitness, scratch);
+        } else {
+            prepareRank(fitness, scratch, scheme == Scheme::ExponentialRank);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t Selection::draw(std::span<const double> fitness, Random& random, Scratch& scratch)
+{
+    if (scratch.drawSampling == Sampling::Universal && scratch.drawScheme != Scheme::Tournament
+        && scratch.drawScheme != Scheme::Panmixia) {
+        return scratch.drawn[scratch.nextDraw++ % scratch.drawn.size()];
+    }
+
+    switch (scratch.drawScheme) {
+    case Scheme::Tournament:
+        return tournamentWinner(fitness, random);
+    case Scheme::Rank:
+    case Scheme::ExponentialRank:
+        return drawRank(scratch, random);
+    case Scheme::Proportional:
+        return drawProportional(scratch, random);
+    default:
+        return static_cast<uint32_t>(random.index(fitness.size()));
+    }
+}
+
+void Selection::tournament(std::span<const double> fitness, Random& random, Parents& parents, const uint32_t tournamentSize)
+{
+    parents.resize(fitness.size());
+
+    std::ranges::generate(parents, [&]() {
+        return tournamentWinner(fitness, random, tournamentSize);
+    });
+}
+
+void Selection::rank(std::span<const double> fitness, Random& random, Parents& parents, Scratch& scratch,
+                     const Sampling sampling)
+{
+    ranked(fitness, random, parents, scratch, sampling, false);
+}
+
+void Selection::exponentialRank(std::span<const double> fitness, Random& random, Parents& parents, Scratch& scratch,
+                                const Sampling sampling)
+{
+    ranked(fitness, random, parents, scratch, sampling, true);
+}
+
+void Selection::panmixia(std::span<const double> fitness, Random& random, Parents& parents)
+{
+    parents.resize(fitness.size());
+
+    std::ranges::generate(parents, [&]() {
+        return static_cast<uint32_t>(random.index(fitness.size()));
+    });
+}
+
+void Selection::proportional(std::span<const double> fitness, Random& random, Parents& parents, Scratch& scratch,
+                             const Sampling sampling)
+{
+    if (sampling == Sampling::Roulette) {
+        prepareProportional(fitness, scratch);
+    } else {
+        proportionalWeights(fitness, scratch.weights);
+    }
+
+    parents.resize(fitness.size());
+    sample(scratch.weights, scratch.alias, random, parents, sampling);
+}
+
+uint32_t Selection::tournamentWinner(std::span<const double> fitness, Random& random, const uint32_t tournamentSize)
+{
+    auto winner = static_cast<uint32_t>(random.index(fitness.size()));
+
+    for (uint32_t i = 1; i < tournamentSize; ++i) {
+        const auto competitor = static_cast<uint32_t>(random.index(fitness.size()));
+
+        if (fitness[competitor] < fitness[winner]) {
+            winner = competitor;
+        }
+    }
+
+    return winner;
+}
+
+void Selection::prepareRank(std::span<const double> fitness, Scratch& scratch, const bool exponential)
+{
+    buildRankTable(fitness.size(), exponential, scratch);
+
+    //! Only the ranks that can be drawn need ordering.
+    auto& order = scratch.order;
+    const auto ranks = scratch.rankWeights.size();
+    const auto better = [&fitness](const auto a, const auto b) {
+        return fitness[a] < fitness[b];
+    };
+
+    order.resize(fitness.size());
+    std::iota(order.begin(), order.end(), uint32_t{});
+
+    if (ranks < order.size()) {
+        std::ranges::nth_element(order, order.begin() + ranks, better);
+    }
+
+    std::sort(order.begin(), order.begin() + ranks, better);
+}
+
+void Selection::prepareProportional(std::span<const double> fitness, Scratch& scratch)
+{
+    proportionalWeights(fitness, scratch.weights);
+    scratch.alias.build(scratch.weights);
+}
+
+uint32_t Selection::inverseTournament(std::span<const double> fitness, Random& random, const uint32_t tournamentSize)
+{
+    auto loser = static_cast<uint32_t>(random.index(fitness.size()));
+
+    for (uint32_t i = 1; i < tournamentSize; ++i) {
+        const auto competitor = static_cast<uint32_t>(random.index(fitness.size()));
+
+        if (fitness[competitor] > fitness[loser]) {
+            loser = competitor;
+        }
+    }
+
+    return loser;
+}
+
+std::optional<uint32_t> Selection::victim(std::span<const double> fitness, const Replacement replacement,
+                                          const double newcomer, Random& random)
+{
+    uint32_t victim = 0;
+
+    switch (replacement) {
+    case Replacement::None:
+        return std::nullopt;
+    case Replacement::Worst:
+        victim = static_cast<uint32_t>(std::distance(fitness.begin(), std::ranges::max_element(fitness)));
+        break;
+    case Replacement::Tournament:
+        victim = inverseTournament(fitness, random);
+        break;
+    case Replacement::Random:
+        return static_cast<uint32_t>(random.index(fitness.size()));
+    }
+
+    if (newcomer >= fitness[victim]) {
+        return std::nullopt;
+    }
+
+    return victim;
+}
+
+void Selection::fittest(std::span<const double> fitness, const size_t count, Parents& indices)
+{
+    const auto n = std::min(count, fitness.size());
+
+    indices.resize(fitness.size());
+    std::iota(indices.begin(), indices.end(), uint32_t{});
+
+    std::ranges::partial_sort(indices, indices.begin() + n, [&fitness](const auto a, const auto b) {
+        return fitness[a] < fitness[b];
+    });
+
+    indices.resize(n);
+}
+
+void Selection::weakest(std::span<const double> fitness, const size_t count, Parents& indices)
+{
+    const auto n = std::min(count, fitness.size());
+
+    indices.resize(fitness.size());
+    std::iota(indices.begin(), indices.end(), uint32_t{});
+
+    std::ranges::partial_sort(indices, indices.begin() + n, [&fitness](const auto a, const auto b) {
+        return fitness[a] > fitness[b];
+    });
+
+    indices.resize(n);
+}
+
+void Selection::ranked(std::span<const double> fitness, Random& random, Parents& parents, Scratch& scratch,
+                       const Sampling sampling, const bool exponential)
+{
+    parents.resize(fitness.size());
+
+    if (fitness.empty()) {
+        return;
+    }
+
+    prepareRank(fitness, scratch, exponential);
+    sample(scratch.rankWeights, scratch.rankTable, random, parents, sampling);
+
+    for (auto& parent : parents) {
+        parent = scratch.order[parent];
+    }
+}
+
+void Selection::proportionalWeights(std::span<const double> fitness, std::vector<double>& weights)
+{
+    weights.resize(fitness.size());
+
+    for (size_t i = 0; i < fitness.size(); ++i) {
+        const auto weight = 1 / fitness[i];
+        weights[i] = std::isfinite(weight) && weight > 0.0 ? weight : 0.0;
+    }
+}
+
+void Selection::buildRankTable(const size_t size, const bool exponential, Scratch& scratch)
+{
+    if (scratch.rankSize == size && scratch.rankExponential == exponential) {
+        return;
+    }
+
+    auto& weights = scratch.rankWeights;
+    weights.clear();
+
+    if (exponential) {
+        const auto ranks = std::min(size, static_cast<size_t>(std::ceil(std::log(1e-12) / std::log(ExponentialBase))));
+        double weight = 1.0;
+
+        for (size_t r = 0; r < ranks; ++r, weight *= ExponentialBase) {
+            weights.push_back(weight);
+        }
+    } else {
+        for (size_t r = 0; r < size; ++r) {
+            weights.push_back(static_cast<double>(size - r));
+        }
+    }
+
+    scratch.rankTable.build(weights);
+    scratch.rankSize = size;
+    scratch.rankExponential = exponential;
+}
+
+void Selection::sample(std::span<const double> weights, const AliasTable& table, Random& random, Parents& parents,
+                       const Sampling sampling)
+{
+    if (sampling == Sampling::Universal) {
+        universal(weights, random, parents);
+        return;
+    }
+
+    std::ranges::generate(parents, [&]() {
+        return table.sample(random);
+    });
+}
+
+void Selection::universal(std::span<const double> weights, Random& random, Parents& parents)
+{
+    const auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    if (parents.empty() || weights.empty()) {
+        return;
+    }
+
+    if (!(total > 0.0)) {
+        std::ranges::generate(parents, [&]() {
+            return static_cast<uint32_t>(random.index(weights.size()));
+        });
+        return;
+    }
+
+    const auto step = total / parents.size();
+    const auto start = random.uniform() * step;
+    double reached = weights[0];
+    uint32_t ix = 0;
+
+    for (size_t i = 0; i < parents.size(); ++i) {
+        const auto pointer = start + i * step;
+
+        while (reached <= pointer && ix + 1 < weights.size()) {
+            reached += weights[++ix];
+        }
+
+        parents[i] = ix;
+    }
+
+    //! The pointers come out in index order, shuffled so that consecutive parents pair up at random.
+    for (size_t i = parents.size() - 1; i > 0; --i) {
+        std::swap(parents[i], parents[random.index(i + 1)]);
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+
+#include "random.h"
+#include "aliastable.h"
+
+//! Selection schemes. They only look at fitness values, so every population layout
+//! shares them; each one fills \a parents with fitness.size() row indices. The few
+//! templates taking a whole pool work on GenePool and BasicGenePool alike.
+class Selection final
+{
+public:
+    using Parents = std::vector<uint32_t>;
+
+    enum class Scheme
+    {
+        None = 0,
+        Tournament,
+        Rank,
+        Panmixia,
+        Proportional,
+        ExponentialRank
+    };
+
+    //! How the weighted schemes draw: independently from an alias table, O(1) a draw, or
+    //! by stochastic universal sampling, evenly spaced pointers over the weights that
+    //! keep every individual's count within one of its expectation.
+    enum class Sampling
+    {
+        Roulette = 0,
+        Universal
+    };
+
+    //! Which row a newcomer takes the place of: the weakest one or the weakest of a
+    //! 3-tournament, each only if the newcomer is fitter, or a random one.
+    enum class Replacement
+    {
+        None = 0,
+        Worst,
+        Tournament,
+        Random
+    };
+
+    //! Kept by the caller between selections, so they stop allocating once warm. The
+    //! rank tables only depend on the population size and are rebuilt when it changes.
+    struct Scratch
+    {
+        std::vector<double> weights;
+        AliasTable alias;
+        Parents order;
+        std::vector<double> rankWeights;
+        AliasTable rankTable;
+        size_t rankSize = 0;
+        bool rankExponential = false;
+        //! Single draws, see prepare() and draw().
+        Scheme drawScheme = Scheme::None;
+        Sampling drawSampling = Sampling::Roulette;
+        Parents drawn;
+        size_t nextDraw = 0;
+    };
+
+    //! Fills \a parents by \a scheme, false for None.
+    static bool select(const Scheme scheme, std::span<const double> fitness, Random& random, Parents& parents,
+                       Scratch& scratch, const Sampling sampling = Sampling::Roulette);
+
+    static void tournament(std::span<const double> fitness, Random& random, Parents& parents, const uint32_t tournamentSize = 3);
+    //! Linear ranking: the best of n individuals has weight n, the worst 1.
+    static void rank(std::span<const double> fitness, Random& random, Parents& parents, Scratch& scratch,
+                     const Sampling sampling = Sampling::Roulette);
+    //! Exponential ranking: rank r (0 the best) has weight ExponentialBase^r. Ranks past
+    //! the point where the tail weighs under 1e-12 are never drawn, so only that many
+    //! individuals get ordered, with nth_element and a partial sort.
+    static void exponentialRank(std::span<const double> fitness, Random& random, Parents& parents, Scratch& scratch,
+                                const Sampling sampling = Sampling::Roulette);
+    static void panmixia(std::span<const double> fitness, Random& random, Parents& parents);
+    //! Weights are 1 / fitness, a non-positive fitness weighs nothing.
+    static void proportional(std::span<const double> fitness, Random& random, Parents& parents, Scratch& scratch,
+                             const Sampling sampling = Sampling::Roulette);
+
+    //! Single draws, for pipelines that breed a pair at a time instead of selecting a
+    //! whole generation up front. The weighted schemes first prepare their table in
+    //! \a scratch, once per generation; every draw is O(1) then. Universal sampling
+    //! spaces its pointers over a whole generation and has no single draw.
+    static uint32_t tournamentWinner(std::span<const double> fitness, Random& random, const uint32_t tournamentSize = 3);
+    static void prepareRank(std::span<const double> fitness, Scratch& scratch, const bool exponential);
+    static uint32_t drawRank(const Scratch& scratch, Random& random) { return scratch.order[scratch.rankTable.sample(random)]; }
+    static void prepareProportional(std::span<const double> fitness, Scratch& scratch);
+    static uint32_t drawProportional(const Scratch& scratch, Random& random) { return scratch.alias.sample(random); }
+
+    //! Parents one at a time by \a scheme: prepare() does the per-generation work and keeps
+    //! it in \a scratch, then every draw() is one parent, distributed as select() would.
+    //! Universal sampling selects the whole generation in prepare() and hands it out in
+    //! order. prepare() fails for None.
+    static bool prepare(const Scheme scheme, std::span<const double> fitness, Random& random, Scratch& scratch,
+                        const Sampling sampling = Sampling::Roulette);
+    static uint32_t draw(std::span<const double> fitness, Random& random, Scratch& scratch);
+
+    //! Index of the weakest of \a tournamentSize random rows, for replacement.
+    static uint32_t inverseTournament(std::span<const double> fitness, Random& random, const uint32_t tournamentSize = 3);
+
+    //! Row a newcomer of fitness \a newcomer replaces under \a replacement, none when it
+    //! does not get in.
+    static std::optional<uint32_t> victim(std::span<const double> fitness, const Replacement replacement,
+                                          const double newcomer, Random& random);
+
+    //! The \a count fittest (lowest fitness) and weakest rows, best and worst first respectively.
+    static void fittest(std::span<const double> fitness, const size_t count, Parents& indices);
+    static void weakest(std::span<const double> fitness, const size_t count, Parents& indices);
+
+    //! Row of \a individuals with the lowest fitness among the clean ones, the lowest of
+    //! all when every row is dirty. Only fitness that came from the fitness function
+    //! counts, not a surrogate's guess.
+    template<class Pool>
+    static size_t best(const Pool& individuals)
+    {
+        const auto fitnesses = individuals.fitnesses();
+        size_t best = fitnesses.size();
+
+        for (size_t i = 0; i < fitnesses.size(); ++i) {
+            if (!individuals.dirty(i) && (best == fitnesses.size() || fitnesses[i] < fitnesses[best])) {
+                best = i;
+            }
+        }
+
+        if (best == fitnesses.size()) {
+            return std::distance(fitnesses.begin(), std::ranges::min_element(fitnesses));
+        }
+
+        return best;
+    }
+
+    //! Island migration: copies the migrants.size() fittest rows of \a individuals into
+    //! \a migrants, or lets \a migrants replace as many of its weakest rows, fitness
+    //! included. \a order is scratch.
+    template<class Pool>
+    static void emigrate(const Pool& individuals, Pool& migrants, Parents& order)
+    {
+        fittest(individuals.fitnesses(), migrants.size(), order);
+
+        for (size_t i = 0; i < order.size(); ++i) {
+            migrants.copyRow(i, individuals, order[i]);
+        }
+    }
+
+    template<class Pool>
+    static void immigrate(Pool& individuals, const Pool& migrants, Parents& order)
+    {
+        weakest(individuals.fitnesses(), migrants.size(), order);
+
+        for (size_t i = 0; i < order.size(); ++i) {
+            individuals.copyRow(order[i], migrants, i);
+        }
+    }
+
+    static constexpr double ExponentialBase = 0.99;
+
+private:
+    static void ranked(std::span<const double> fitness, Random& random, Parents& parents, Scratch& scratch,
+                       const Sampling sampling, const bool exponential);
+    static void buildRankTable(const size_t size, const bool exponential, Scratch& scratch);
+    static void proportionalWeights(std::span<const double> fitness, std::vector<double>& weights);
+    //! Fills parents.size() draws from \a weights, either way.
+    static void sample(std::span<const double> weights, const AliasTable& table, Random& random, Parents& parents,
+                       const Sampling sampling);
+    static void universal(std::span<const double> weights, Random& random, Parents& parents);
+};
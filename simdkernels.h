@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+//! Vectorized benchmark functions over a row-major gene matrix, one SIMD lane per
+//! individual. Every class lives in its own translation unit built with its own
+//! instruction set flags: only call one after CpuFeatures reports support for it.
+class Avx2Kernels final
+{
+public:
+    static void sphere(const double* genes, const size_t rows, const size_t dimentions, double* out);
+    static void rastrigin(const double* genes, const size_t rows, const size_t dimentions, double* out);
+    static void rosenbrock(const double* genes, const size_t rows, const size_t dimentions, double* out);
+    static void ackley(const double* genes, const size_t rows, const size_t dimentions, double* out);
+    static void michalewicz(const double* genes, const size_t rows, const size_t dimentions, double* out, const int m);
+};
+
+class Avx512Kernels final
+{
+public:
+    static void sphere(const double* genes, const size_t rows, const size_t dimentions, double* out);
+    static void rastrigin(const double* genes, const size_t rows, const size_t dimentions, double* out);
+    static void rosenbrock(const double* genes, const size_t rows, const size_t dimentions, double* out);
+    static void ackley(const double* genes, const size_t rows, const size_t dimentions, double* out);
+    static void michalewicz(const double* genes, const size_t rows, const size_t dimentions, double* out, const int m);
+};
@@ -0,0 +1,74 @@
+#include "simdkernels.h"
+
+#include <immintrin.h>
+
+#include "simdkernelsimpl.h"
+
+namespace
+{
+struct Avx2
+{
+    using Vec = __m256d;
+    using Index = __m256i;
+    static constexpr size_t Width = 4;
+
+    static Vec set1(const double v) { return _mm256_set1_pd(v); }
+    static Vec add(const Vec a, const Vec b) { return _mm256_add_pd(a, b); }
+    static Vec sub(const Vec a, const Vec b) { return _mm256_sub_pd(a, b); }
+    static Vec mul(const Vec a, const Vec b) { return _mm256_mul_pd(a, b); }
+    static Vec min(const Vec a, const Vec b) { return _mm256_min_pd(a, b); }
+    static Vec max(const Vec a, const Vec b) { return _mm256_max_pd(a, b); }
+    static Vec sqrt(const Vec a) { return _mm256_sqrt_pd(a); }
+    //! a * b + c
+    static Vec fmadd(const Vec a, const Vec b, const Vec c) { return _mm256_fmadd_pd(a, b, c); }
+    //! c - a * b
+    static Vec fnmadd(const Vec a, const Vec b, const Vec c) { return _mm256_fnmadd_pd(a, b, c); }
+    static Vec round(const Vec a) { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    //! \a k holds integral values, the ones that are odd flip the sign of \a v.
+    static Vec flipSignIfOdd(const Vec v, const Vec k)
+    {
+        //! Adding 1.5 * 2^52 moves the integer into the low mantissa bits.
+        const auto bits = _mm256_castpd_si256(_mm256_add_pd(k, _mm256_set1_pd(0x1.8p52)));
+        const auto sign = _mm256_slli_epi64(_mm256_and_si256(bits, _mm256_set1_epi64x(1)), 63);
+        return _mm256_xor_pd(v, _mm256_castsi256_pd(sign));
+    }
+
+    //! 2^k for integral k in the normal exponent range.
+    static Vec pow2(const Vec k)
+    {
+        const auto integer = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k));
+        const auto exponent = _mm256_slli_epi64(_mm256_add_epi64(integer, _mm256_set1_epi64x(1023)), 52);
+        return _mm256_castsi256_pd(exponent);
+    }
+
+    static Index loadIndex(const int64_t* offsets) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(offsets)); }
+    static Vec gather(const double* base, const Index index) { return _mm256_i64gather_pd(base, index, 8); }
+    static void store(double* out, const Vec v) { _mm256_storeu_pd(out, v); }
+};
+}
+
+void Avx2Kernels::sphere(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    sphereKernel<Avx2>(genes, rows, dimentions, out);
+}
+
+void Avx2Kernels::rastrigin(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    rastriginKernel<Avx2>(genes, rows, dimentions, out);
+}
+
+void Avx2Kernels::rosenbrock(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    rosenbrockKernel<Avx2>(genes, rows, dimentions, out);
+}
+
+void Avx2Kernels::ackley(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    ackleyKernel<Avx2>(genes, rows, dimentions, out);
+}
+
+void Avx2Kernels::michalewicz(const double* genes, const size_t rows, const size_t dimentions, double* out, const int m)
+{
+    michalewiczKernel<Avx2>(genes, rows, dimentions, out, m);
+}
@@ -0,0 +1,74 @@
+#include "simdkernels.h"
+
+#include <immintrin.h>
+
+#include "simdkernelsimpl.h"
+
+namespace
+{
+struct Avx512
+{
+    using Vec = __m512d;
+    using Index = __m512i;
+    static constexpr size_t Width = 8;
+
+    static Vec set1(const double v) { return _mm512_set1_pd(v); }
+    static Vec add(const Vec a, const Vec b) { return _mm512_add_pd(a, b); }
+    static Vec sub(const Vec a, const Vec b) { return _mm512_sub_pd(a, b); }
+    static Vec mul(const Vec a, const Vec b) { return _mm512_mul_pd(a, b); }
+    static Vec min(const Vec a, const Vec b) { return _mm512_min_pd(a, b); }
+    static Vec max(const Vec a, const Vec b) { return _mm512_max_pd(a, b); }
+    static Vec sqrt(const Vec a) { return _mm512_sqrt_pd(a); }
+    //! a * b + c
+    static Vec fmadd(const Vec a, const Vec b, const Vec c) { return _mm512_fmadd_pd(a, b, c); }
+    //! c - a * b
+    static Vec fnmadd(const Vec a, const Vec b, const Vec c) { return _mm512_fnmadd_pd(a, b, c); }
+    static Vec round(const Vec a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    //! \a k holds integral values, the ones that are odd flip the sign of \a v.
+    static Vec flipSignIfOdd(const Vec v, const Vec k)
+    {
+        //! Adding 1.5 * 2^52 moves the integer into the low mantissa bits.
+        const auto bits = _mm512_castpd_si512(_mm512_add_pd(k, _mm512_set1_pd(0x1.8p52)));
+        const auto sign = _mm512_slli_epi64(_mm512_and_si512(bits, _mm512_set1_epi64(1)), 63);
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(v), sign));
+    }
+
+    //! 2^k for integral k in the normal exponent range.
+    static Vec pow2(const Vec k)
+    {
+        const auto integer = _mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(k));
+        const auto exponent = _mm512_slli_epi64(_mm512_add_epi64(integer, _mm512_set1_epi64(1023)), 52);
+        return _mm512_castsi512_pd(exponent);
+    }
+
+    static Index loadIndex(const int64_t* offsets) { return _mm512_load_si512(offsets); }
+    static Vec gather(const double* base, const Index index) { return _mm512_i64gather_pd(index, base, 8); }
+    static void store(double* out, const Vec v) { _mm512_storeu_pd(out, v); }
+};
+}
+
+void Avx512Kernels::sphere(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    sphereKernel<Avx512>(genes, rows, dimentions, out);
+}
+
+void Avx512Kernels::rastrigin(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    rastriginKernel<Avx512>(genes, rows, dimentions, out);
+}
+
+void Avx512Kernels::rosenbrock(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    rosenbrockKernel<Avx512>(genes, rows, dimentions, out);
+}
+
+void Avx512Kernels::ackley(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    ackleyKernel<Avx512>(genes, rows, dimentions, out);
+}
+
+void Avx512Kernels::michalewicz(const double* genes, const size_t rows, const size_t dimentions, double* out, const int m)
+{
+    michalewiczKernel<Avx512>(genes, rows, dimentions, out, m);
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+//! Shared body of the SIMD kernels, included only by the per instruction set
+//! translation units. Everything sits in an anonymous namespace so that code
+//! compiled with different -m flags never gets merged by the linker.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+constexpr double Pi = 3.14159265358979323846;
+constexpr double E = 2.71828182845904523536;
+
+//! Cody-Waite split of pi and ln(2), the high parts have trailing zero bits so
+//! k * high is exact for the argument ranges we care about.
+constexpr double PiA = 3.1415926218032836914;
+constexpr double PiB = 3.1786509424591713469e-08;
+constexpr double PiC = 1.2246467864107188502e-16;
+constexpr double Ln2Hi = 6.93145751953125e-1;
+constexpr double Ln2Lo = 1.42860682030941723212e-6;
+
+//! sin(r) on [-pi/2, pi/2], odd Taylor terms up to r^17 (|error| < 1e-12).
+template<class Isa>
+typename Isa::Vec sinReduced(const typename Isa::Vec r)
+{
+    const auto r2 = Isa::mul(r, r);
+    auto p = Isa::set1(1.0 / 355687428096000.0);
+    p = Isa::fmadd(p, r2, Isa::set1(-1.0 / 1307674368000.0));
+    p = Isa::fmadd(p, r2, Isa::set1(1.0 / 6227020800.0));
+    p = Isa::fmadd(p, r2, Isa::set1(-1.0 / 39916800.0));
+    p = Isa::fmadd(p, r2, Isa::set1(1.0 / 362880.0));
+    p = Isa::fmadd(p, r2, Isa::set1(-1.0 / 5040.0));
+    p = Isa::fmadd(p, r2, Isa::set1(1.0 / 120.0));
+    p = Isa::fmadd(p, r2, Isa::set1(-1.0 / 6.0));
+    return Isa::fmadd(Isa::mul(p, r2), r, r);
+}
+
+template<class Isa>
+typename Isa::Vec vsin(const typename Isa::Vec x)
+{
+    const auto k = Isa::round(Isa::mul(x, Isa::set1(1.0 / Pi)));
+    auto r = Isa::fnmadd(k, Isa::set1(PiA), x);
+    r = Isa::fnmadd(k, Isa::set1(PiB), r);
+    r = Isa::fnmadd(k, Isa::set1(PiC), r);
+
+    //! sin(x) = (-1)^k sin(x - k pi)
+    return Isa::flipSignIfOdd(sinReduced<Isa>(r), k);
+}
+
+template<class Isa>
+typename Isa::Vec vcos(const typename Isa::Vec x)
+{
+    //! cos(x) = (-1)^k sin(x - (k - 1/2) pi), k = round(x / pi + 1/2)
+    const auto k = Isa::round(Isa::fmadd(x, Isa::set1(1.0 / Pi), Isa::set1(0.5)));
+    const auto half = Isa::sub(k, Isa::set1(0.5));
+    auto r = Isa::fnmadd(half, Isa::set1(PiA), x);
+    r = Isa::fnmadd(half, Isa::set1(PiB), r);
+    r = Isa::fnmadd(half, Isa::set1(PiC), r);
+
+    return Isa::flipSignIfOdd(sinReduced<Isa>(r), k);
+}
+
+template<class Isa>
+typename Isa::Vec vexp(typename Isa::Vec x)
+{
+    x = Isa::max(Isa::min(x, Isa::set1(709.0)), Isa::set1(-708.0));
+
+    const auto k = Isa::round(Isa::mul(x, Isa::set1(1.4426950408889634074)));
+    auto r = Isa::fnmadd(k, Isa::set1(Ln2Hi), x);
+    r = Isa::fnmadd(k, Isa::set1(Ln2Lo), r);
+
+    //! exp(r) on [-ln2/2, ln2/2], Taylor terms up to r^12.
+    auto p = Isa::set1(1.0 / 479001600.0);
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 39916800.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 3628800.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 362880.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 40320.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 5040.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 720.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 120.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 24.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0 / 6.0));
+    p = Isa::fmadd(p, r, Isa::set1(0.5));
+    p = Isa::fmadd(p, r, Isa::set1(1.0));
+    p = Isa::fmadd(p, r, Isa::set1(1.0));
+
+    return Isa::mul(p, Isa::pow2(k));
+}
+
+//! x^n for a small non-negative integer n, by repeated squaring.
+template<class Isa>
+typename Isa::Vec powi(typename Isa::Vec x, int n)
+{
+    auto result = Isa::set1(1.0);
+
+    while (n > 0) {
+        if (n & 1) {
+            result = Isa::mul(result, x);
+        }
+
+        x = Isa::mul(x, x);
+        n >>= 1;
+    }
+
+    return result;
+}
+
+//! Walks the matrix Isa::Width rows at a time, gathering column i of every row in the
+//! group into one vector. Rows past the end repeat the last row and are not stored.
+template<class Isa, class Body>
+void forEachGroup(const double* genes, const size_t rows, const size_t dimentions, double* out, Body body)
+{
+    for (size_t row = 0; row < rows; row += Isa::Width) {
+        alignas(64) int64_t offsets[Isa::Width];
+
+        for (size_t lane = 0; lane < Isa::Width; ++lane) {
+            const auto ix = row + lane < rows ? row + lane : rows - 1;
+            offsets[lane] = static_cast<int64_t>(ix * dimentions);
+        }
+
+        const auto index = Isa::loadIndex(offsets);
+        const auto column = [&](const size_t i) {
+            return Isa::gather(genes + i, index);
+        };
+
+        const auto result = body(column);
+        const auto count = rows - row < Isa::Width ? rows - row : Isa::Width;
+
+        if (count == Isa::Width) {
+            Isa::store(out + row, result);
+        } else {
+            alignas(64) double tail[Isa::Width];
+            Isa::store(tail, result);
+
+            for (size_t lane = 0; lane < count; ++lane) {
+                out[row + lane] = tail[lane];
+            }
+        }
+    }
+}
+
+template<class Isa>
+void sphereKernel(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    forEachGroup<Isa>(genes, rows, dimentions, out, [dimentions](const auto& column) {
+        auto sum = Isa::set1(0.0);
+
+        for (size_t i = 0; i < dimentions; ++i) {
+            const auto x = column(i);
+            sum = Isa::fmadd(x, x, sum);
+        }
+
+        return sum;
+    });
+}
+
+template<class Isa>
+void rastriginKernel(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    forEachGroup<Isa>(genes, rows, dimentions, out, [dimentions](const auto& column) {
+        auto sum = Isa::set1(10.0 * dimentions);
+
+        for (size_t i = 0; i < dimentions; ++i) {
+            const auto x = column(i);
+            const auto c = vcos<Isa>(Isa::mul(x, Isa::set1(2.0 * Pi)));
+            sum = Isa::fmadd(x, x, Isa::fnmadd(c, Isa::set1(10.0), sum));
+        }
+
+        return sum;
+    });
+}
+
+template<class Isa>
+void rosenbrockKernel(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    forEachGroup<Isa>(genes, rows, dimentions, out, [dimentions](const auto& column) {
+        auto sum = Isa::set1(0.0);
+
+        if (dimentions < 2) {
+            return sum;
+        }
+
+        auto x = column(0);
+
+        for (size_t i = 0; i + 1 < dimentions; ++i) {
+            const auto next = column(i + 1);
+            const auto a = Isa::fnmadd(x, x, next);
+            const auto b = Isa::sub(Isa::set1(1.0), x);
+            sum = Isa::fmadd(Isa::mul(a, a), Isa::set1(100.0), Isa::fmadd(b, b, sum));
+            x = next;
+        }
+
+        return sum;
+    });
+}
+
+template<class Isa>
+void ackleyKernel(const double* genes, const size_t rows, const size_t dimentions, double* out)
+{
+    forEachGroup<Isa>(genes, rows, dimentions, out, [dimentions](const auto& column) {
+        auto squares = Isa::set1(0.0);
+        auto cosines = Isa::set1(0.0);
+
+        for (size_t i = 0; i < dimentions; ++i) {
+            const auto x = column(i);
+            squares = Isa::fmadd(x, x, squares);
+            cosines = Isa::add(cosines, vcos<Isa>(Isa::mul(x, Isa::set1(2.0 * Pi))));
+        }
+
+        const auto inverse = Isa::set1(1.0 / dimentions);
+        const auto first = vexp<Isa>(Isa::mul(Isa::set1(-0.2), Isa::sqrt(Isa::mul(squares, inverse))));
+        const auto second = vexp<Isa>(Isa::mul(cosines, inverse));
+
+        return Isa::sub(Isa::fnmadd(first, Isa::set1(20.0), Isa::set1(20.0 + E)), second);
+    });
+}
+
+template<class Isa>
+void michalewiczKernel(const double* genes, const size_t rows, const size_t dimentions, double* out, const int m)
+{
+    forEachGroup<Isa>(genes, rows, dimentions, out, [dimentions, m](const auto& column) {
+        auto sum = Isa::set1(0.0);
+
+        for (size_t i = 0; i < dimentions; ++i) {
+            const auto x = column(i);
+            const auto arg = Isa::mul(Isa::mul(x, x), Isa::set1((i + 1) / Pi));
+            const auto s = vsin<Isa>(arg);
+            sum = Isa::fmadd(vsin<Isa>(x), powi<Isa>(Isa::mul(s, s), m), sum);
+        }
+
+        return Isa::sub(Isa::set1(0.0), sum);
+    });
+}
+}
@@ -0,0 +1,173 @@
+#include "snapshot.h"
+
+#include <chrono>
+#include <fstream>
+#include <utility>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static_assert(sizeof(Snapshot::Header) % 8 == 0, "rows have to start 8-byte aligned");
+
+Snapshot::Header Snapshot::header(std::span<const std::byte> bytes)
+{
+    Header header;
+
+    if (bytes.size() < sizeof(Header)) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+
+    if (header.magic != Magic) {
+        throw std::runtime_error("Not a snapshot");
+    }
+
+    if (header.byteOrder != ByteOrder) {
+        throw std::runtime_error("Snapshot was written with another byte order");
+    }
+
+    if (header.version != Version) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version));
+    }
+
+    if (bytes.size() != bytesFor(header)) {
+        throw std::runtime_error("Snapshot is truncated");
+    }
+
+    return header;
+}
+
+size_t Snapshot::bytesFor(const Header& header)
+{
+    const auto rows = header.size + 1;
+    return sizeof(Header) + align(rows * header.rowBytes) + rows * sizeof(double) + rows;
+}
+
+SnapshotWriter::SnapshotWriter(std::string path)
+    : m_path{std::move(path)}
+{}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    if (m_pending.valid()) {
+        m_pending.wait();
+    }
+}
+
+bool SnapshotWriter::ready() const
+{
+    return !m_pending.valid() || m_pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+std::vector<std::byte>& SnapshotWriter::buffer()
+{
+    return m_buffer;
+}
+
+void SnapshotWriter::commit()
+{
+    if (m_pending.valid()) {
+        m_pending.get();
+    }
+
+    m_pending = std::async(std::launch::async, [this]() {
+        const auto temporary = m_path + ".tmp";
+
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()));
+
+            if (!out) {
+                throw std::runtime_error("Failed to write " + temporary);
+            }
+        }
+
+        std::filesystem::rename(temporary, m_path);
+    });
+
+    ++m_written;
+}
+
+void SnapshotWriter::wait()
+{
+    if (m_pending.valid()) {
+        m_pending.get();
+    }
+}
+
+const std::string& SnapshotWriter::path() const
+{
+    return m_path;
+}
+
+uint64_t SnapshotWriter::written() const
+{
+    return m_written;
+}
+
+MappedFile::MappedFile(const std::string& path)
+{
+#ifndef _WIN32
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    struct stat status;
+
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    m_size = static_cast<size_t>(status.st_size);
+
+    if (m_size > 0) {
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to map " + path);
+        }
+
+        ::madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const std::byte*>(data);
+    }
+
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+
+    if (!in) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    m_copy.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(m_copy.data()), static_cast<std::streamsize>(m_copy.size()));
+
+    m_data = m_copy.data();
+    m_size = m_copy.size();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (m_data) {
+        ::munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+#endif
+}
+
+std::span<const std::byte> MappedFile::bytes() const
+{
+    return {m_data, m_size};
+}
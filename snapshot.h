@@ -0,0 +1,261 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <future>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <stdexcept>
+
+#include "random.h"
+#include "individual.h"
+
+//! Binary checkpoint of a run: a versioned header followed by size() + 1 rows (the
+//! population, then the best individual so far) as raw gene or code bytes, their
+//! fitness and their dirty flags. Gray and 16-bit genes only mean something on their
+//! bounds, so the header keeps the bounds and the gene precision too. Everything is
+//! native byte order and 8-byte aligned, so a mapped snapshot is read with plain copies.
+class Snapshot final
+{
+public:
+    static constexpr uint32_t Version = 3;
+    using Bounds = std::pair<double, double>;
+
+    //! Run state besides the rows and the random stream.
+    struct Progress
+    {
+        //! The epoch to continue with: its fitness is known, selection comes next.
+        uint64_t epoch = 0;
+        //! Fitness calls so far, for Termination::maxEvaluations.
+        uint64_t evaluations = 0;
+        //! Stall detection: the best fitness the epochs are compared with, and the epoch
+        //! it was reached in.
+        double stallBest = 0.0;
+        uint64_t stallSince = 0;
+        //! Multipliers of the operator rates, see PopulationSettings::adaptiveRates.
+        double mutationScale = 1.0;
+        double crossoverScale = 1.0;
+    };
+
+    struct Header
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t size;
+        uint64_t dimentions;
+        uint64_t rowBytes;
+        uint32_t type;
+        uint32_t bitsPerGene;
+        //! GenePool::Precision, Double for pools without one.
+        uint32_t precision;
+        double lowerBound;
+        double upperBound;
+        Progress progress;
+        Random::State random;
+    };
+
+    //! Validated header of \a bytes, throws std::runtime_error on anything that is not a
+    //! complete snapshot of this version.
+    static Header header(std::span<const std::byte> bytes);
+
+    //! Packs \a individuals, \a best (one row) and the rest of the run state into \a out,
+    //! reusing its capacity.
+    template<class Pool>
+    static void save(const Pool& individuals, const Pool& best, const Random& random, const Bounds& bounds,
+                     const Progress& progress, std::vector<std::byte>& out)
+    {
+        const auto rows = individuals.size() + 1;
+        const auto rowBytes = individuals.size() > 0 ? individuals.rowBytes(0).size() : best.rowBytes(0).size();
+
+        //! Zeroed padding included, so that equal run states give equal files: the header
+        //! has holes after precision and in Random::State, which value-initialization
+        //! leaves undefined.
+        Header header;
+        std::memset(static_cast<void*>(&header), 0, sizeof(header));
+        header.magic = Magic;
+        header.version = Version;
+        header.byteOrder = ByteOrder;
+        header.size = individuals.size();
+        header.dimentions = individuals.dimentions();
+        header.rowBytes = rowBytes;
+        header.type = static_cast<uint32_t>(individuals.type());
+        header.bitsPerGene = bitsPerGene(individuals);
+        header.precision = precision(individuals);
+        header.lowerBound = bounds.first;
+        header.upperBound = bounds.second;
+        header.progress = progress;
+        //! Member by member, a whole State copy may carry its padding along.
+        const auto state = random.state();
+        header.random.seed = state.seed;
+        header.random.stream = state.stream;
+        header.random.block = state.block;
+        header.random.spare = state.spare;
+        header.random.position = state.position;
+        header.random.hasSpare = state.hasSpare;
+
+        out.resize(bytesFor(header));
+        std::memcpy(out.data(), &header, sizeof(header));
+
+        auto* genes = out.data() + sizeof(Header);
+        auto* fitness = genes + align(rows * rowBytes);
+        auto* dirty = fitness + rows * sizeof(double);
+
+        for (size_t i = 0; i < rows; ++i) {
+            const auto& pool = i < individuals.size() ? individuals : best;
+            const auto ix = i < individuals.size() ? i : 0;
+            const double value = pool.fitness(ix);
+            const auto flag = static_cast<uint8_t>(pool.dirty(ix));
+
+            std::memcpy(genes + i * rowBytes, pool.rowBytes(ix).data(), rowBytes);
+            std::memcpy(fitness + i * sizeof(double), &value, sizeof(double));
+            std::memcpy(dirty + i, &flag, 1);
+        }
+    }
+
+    //! Unpacks \a bytes into \a individuals and \a best, which have to be of the
+    //! snapshot's shape, precision and \a bounds already (see header()). Returns the
+    //! random stream to continue with and sets \a progress.
+    template<class Pool>
+    static Random restore(std::span<const std::byte> bytes, Pool& individuals, Pool& best, const Bounds& bounds,
+                          Progress& progress)
+    {
+        const auto header = Snapshot::header(bytes);
+        const auto rows = header.size + 1;
+
+        if (header.size != individuals.size() || header.dimentions != individuals.dimentions()
+            || header.type != static_cast<uint32_t>(individuals.type()) || header.bitsPerGene != bitsPerGene(individuals)
+            || best.size() != 1 || header.rowBytes != best.rowBytes(0).size()) {
+            throw std::runtime_error("Snapshot does not match the population settings");
+        }
+
+        if (header.precision != precision(individuals)) {
+            throw std::runtime_error("Snapshot was written with another gene precision");
+        }
+
+        if (header.lowerBound != bounds.first || header.upperBound != bounds.second) {
+            throw std::runtime_error("Snapshot was written with other bounds");
+        }
+
+        const auto* genes = bytes.data() + sizeof(Header);
+        const auto* fitness = genes + align(rows * header.rowBytes);
+        const auto* dirty = fitness + rows * sizeof(double);
+
+        for (size_t i = 0; i < rows; ++i) {
+            auto& pool = i < individuals.size() ? individuals : best;
+            const auto ix = i < individuals.size() ? i : 0;
+            double value;
+
+            std::memcpy(writableRow(pool, ix).data(), genes + i * header.rowBytes, header.rowBytes);
+            std::memcpy(&value, fitness + i * sizeof(double), sizeof(double));
+            pool.setFitness(ix, value);
+            pool.setDirty(ix, dirty[i] != std::byte{0});
+        }
+
+        progress = header.progress;
+
+        return Random(header.random);
+    }
+
+private:
+    static constexpr std::array<char, 8> Magic = {'G', 'A', 'S', 'N', 'A', 'P', '\0', '\0'};
+    static constexpr uint32_t ByteOrder = 0x01020304;
+
+    static constexpr size_t align(const size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+    static size_t bytesFor(const Header& header);
+
+    template<class Pool>
+    static uint32_t bitsPerGene(const Pool& pool)
+    {
+        if constexpr (requires { pool.bitsPerGene(); }) {
+            return pool.type() == Individual::Type::GrayCode ? pool.bitsPerGene() : 0;
+        }
+
+        return 0;
+    }
+
+    template<class Pool>
+    static uint32_t precision(const Pool& pool)
+    {
+        if constexpr (requires { pool.precision(); }) {
+            return static_cast<uint32_t>(pool.precision());
+        }
+
+        return 0;
+    }
+
+    template<class Pool>
+    static std::span<std::byte> writableRow(Pool& pool, const size_t ix)
+    {
+        if constexpr (requires { pool.writableRowBytes(ix); }) {
+            return pool.writableRowBytes(ix);
+        }
+
+        if constexpr (requires { pool.codes(ix); }) {
+            if (pool.type() == Individual::Type::GrayCode) {
+                return std::as_writable_bytes(pool.codes(ix));
+            }
+        }
+
+        if constexpr (requires { pool.genes(ix); }) {
+            return std::as_writable_bytes(pool.genes(ix));
+        }
+
+        return {};
+    }
+};
+
+//! Writes snapshots to \a path off the calling thread: the snapshot goes to path.tmp
+//! first and is renamed over path once complete, so a crash mid-write leaves the
+//! previous one intact. Only one write is in flight at a time.
+class SnapshotWriter final
+{
+public:
+    explicit SnapshotWriter(std::string path);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    //! False while the previous snapshot is still being written; the caller skips
+    //! this one rather than wait.
+    bool ready() const;
+    //! Where to pack the next snapshot, only while ready().
+    std::vector<std::byte>& buffer();
+    //! Starts writing buffer(). Rethrows the error of the previous write, if any.
+    void commit();
+    //! Blocks until the write in flight is done, rethrowing its error.
+    void wait();
+
+    const std::string& path() const;
+    //! Snapshots committed so far.
+    uint64_t written() const;
+
+private:
+    std::string m_path;
+    std::vector<std::byte> m_buffer;
+    std::future<void> m_pending;
+    uint64_t m_written = 0;
+};
+
+//! Read-only view of a whole file: mmap where available, a plain read elsewhere.
+class MappedFile final
+{
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const std::byte> bytes() const;
+
+private:
+    const std::byte* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<std::byte> m_copy;
+};
@@ -0,0 +1,50 @@
+#include "statistics.h"
+
+#include <limits>
+
+Statistics::Summary Statistics::summarize(std::span<const double> fitness)
+{
+    if (fitness.empty()) {
+        return Summary{};
+    }
+
+    Summary summary{std::numeric_limits<double>::max()};
+    double m2 = 0.0;
+
+    for (size_t i = 0; i < fitness.size(); ++i) {
+        summary.best = std::min(summary.best, fitness[i]);
+
+        const auto delta = fitness[i] - summary.mean;
+        summary.mean += delta / (i + 1);
+        m2 += delta * (fitness[i] - summary.mean);
+    }
+
+    summary.stddev = std::sqrt(m2 / fitness.size());
+
+    return summary;
+}
+
+std::optional<Statistics::Quantiles> Statistics::quantiles(std::span<double> values)
+{
+    if (values.empty()) {
+        return std::nullopt;
+    }
+
+    std::ranges::sort(values);
+
+    const auto at = [&values](const double q) {
+        const auto position = q * (values.size() - 1);
+        const auto low = static_cast<size_t>(position);
+        const auto high = std::min(low + 1, values.size() - 1);
+
+        return values[low] + (position - low) * (values[high] - values[low]);
+    };
+
+    double mean = 0.0;
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        mean += (values[i] - mean) / (i + 1);
+    }
+
+    return Quantiles{values.front(), at(0.25), at(0.5), at(0.75), values.back(), mean};
+}
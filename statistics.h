@@ -0,0 +1,79 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cmath>
+#include <utility>
+#include <optional>
+#include <algorithm>
+
+#include "fitnessevaluator.h"
+
+//! Population statistics for telemetry.
+class Statistics final
+{
+public:
+    using Bounds = std::pair<double, double>;
+
+    struct Summary
+    {
+        double best = 0.0;
+        double mean = 0.0;
+        double stddev = 0.0;
+    };
+
+    //! Five-number summary plus the mean, quantiles linearly interpolated.
+    struct Quantiles
+    {
+        double min = 0.0;
+        double q25 = 0.0;
+        double median = 0.0;
+        double q75 = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+    };
+
+    //! Lowest, mean and standard deviation of \a fitness in one pass.
+    static Summary summarize(std::span<const double> fitness);
+
+    //! Quantiles of \a values, which get sorted. None when there are no values, so that
+    //! an empty sample is not mistaken for one of zeros.
+    static std::optional<Quantiles> quantiles(std::span<double> values);
+
+    //! Mean over the genes of their standard deviation across the population, in units
+    //! of the bounds width: 0 when every individual is the same, about 0.29 for uniform
+    //! random genes. Gray codes are decoded first. \a scratch keeps the per-gene sums.
+    template<class Pool>
+    static double diversity(const Pool& pool, const Bounds& bounds, std::vector<double>& scratch)
+    {
+        const auto dimentions = pool.dimentions();
+
+        if (pool.size() == 0 || dimentions == 0) {
+            return 0.0;
+        }
+
+        scratch.assign(3 * dimentions, 0.0);
+
+        const auto row = std::span<double>(scratch).first(dimentions);
+        const auto mean = std::span<double>(scratch).subspan(dimentions, dimentions);
+        const auto m2 = std::span<double>(scratch).subspan(2 * dimentions, dimentions);
+
+        for (size_t i = 0; i < pool.size(); ++i) {
+            FitnessEvaluator::decode(pool, i, row, bounds);
+
+            for (size_t g = 0; g < dimentions; ++g) {
+                const auto delta = row[g] - mean[g];
+                mean[g] += delta / (i + 1);
+                m2[g] += delta * (row[g] - mean[g]);
+            }
+        }
+
+        double total = 0.0;
+
+        for (const auto m : m2) {
+            total += std::sqrt(m / pool.size());
+        }
+
+        return total / dimentions / (bounds.second - bounds.first);
+    }
+};
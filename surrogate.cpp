@@ -0,0 +1,217 @@
+#include "surrogate.h"
+
+#include <numeric>
+#include <algorithm>
+
+KdTree::KdTree(const size_t dimentions, const size_t capacity)
+    : m_dimentions{dimentions}
+    , m_capacity{std::max<size_t>(capacity, 2)}
+{}
+
+void KdTree::reset(const size_t dimentions, const size_t capacity)
+{
+    m_dimentions = dimentions;
+    m_capacity = std::max<size_t>(capacity, 2);
+    m_points.clear();
+    m_values.clear();
+    m_nodes.clear();
+    m_root = NoNode;
+    m_built = 0;
+}
+
+void KdTree::insert(std::span<const double> point, const double value)
+{
+    if (m_dimentions == 0) {
+        return;
+    }
+
+    if (m_values.size() >= m_capacity) {
+        dropOldest(m_capacity / 2);
+    }
+
+    const auto ix = static_cast<uint32_t>(m_values.size());
+
+    m_points.insert(m_points.end(), point.begin(), point.begin() + m_dimentions);
+    m_values.push_back(value);
+    m_nodes.emplace_back();
+
+    if (m_values.size() > 2 * m_built + 16) {
+        rebuild();
+        return;
+    }
+
+    if (m_root == NoNode) {
+        m_root = ix;
+        return;
+    }
+
+    auto node = m_root;
+    size_t depth = 0;
+
+    while (true) {
+        auto& parent = m_nodes[node];
+        auto& child = point[parent.axis] < m_points[node * m_dimentions + parent.axis] ? parent.left : parent.right;
+        ++depth;
+
+        if (child == NoNode) {
+            child = ix;
+            m_nodes[ix].axis = static_cast<uint32_t>(depth % m_dimentions);
+            return;
+        }
+
+        node = child;
+    }
+}
+
+void KdTree::nearest(std::span<const double> query, const size_t k, std::vector<std::pair<double, double>>& out)
+{
+    out.clear();
+
+    if (m_root == NoNode || k == 0) {
+        return;
+    }
+
+    //! out is a max-heap on distance while searching, the worst of the k best on top.
+    const auto farther = [](const auto& a, const auto& b) { return a.first < b.first; };
+
+    m_stack.clear();
+    m_stack.push_back(Visit{m_root, 0.0});
+
+    while (!m_stack.empty()) {
+        const auto visit = m_stack.back();
+        m_stack.pop_back();
+
+        if (out.size() == k && visit.bound >= out.front().first) {
+            continue;
+        }
+
+        const auto here = point(visit.node);
+        double distance = 0.0;
+
+        for (size_t d = 0; d < m_dimentions; ++d) {
+            const auto delta = query[d] - here[d];
+            distance += delta * delta;
+        }
+
+        if (out.size() < k) {
+            out.emplace_back(distance, m_values[visit.node]);
+            std::ranges::push_heap(out, farther);
+        } else if (distance < out.front().first) {
+            std::ranges::pop_heap(out, farther);
+            out.back() = {distance, m_values[visit.node]};
+            std::ranges::push_heap(out, farther);
+        }
+
+        const auto& node = m_nodes[visit.node];
+        const auto offset = query[node.axis] - here[node.axis];
+        const auto nearSide = offset < 0.0 ? node.left : node.right;
+        const auto farSide = offset < 0.0 ? node.right : node.left;
+
+        //! The far side is pushed first so the near one is searched first.
+        if (farSide != NoNode) {
+            m_stack.push_back(Visit{farSide, std::max(visit.bound, offset * offset)});
+        }
+
+        if (nearSide != NoNode) {
+            m_stack.push_back(Visit{nearSide, visit.bound});
+        }
+    }
+
+    std::ranges::sort_heap(out, farther);
+}
+
+size_t KdTree::size() const
+{
+    return m_values.size();
+}
+
+size_t KdTree::dimentions() const
+{
+    return m_dimentions;
+}
+
+std::span<const double> KdTree::point(const uint32_t ix) const
+{
+    return std::span<const double>(m_points).subspan(ix * m_dimentions, m_dimentions);
+}
+
+void KdTree::dropOldest(const size_t count)
+{
+    const auto first = m_values.size() - count;
+
+    m_points.erase(m_points.begin(), m_points.begin() + first * m_dimentions);
+    m_values.erase(m_values.begin(), m_values.begin() + first);
+    m_nodes.resize(count);
+    rebuild();
+}
+
+void KdTree::rebuild()
+{
+    m_ids.resize(m_values.size());
+    std::iota(m_ids.begin(), m_ids.end(), uint32_t{});
+
+    m_root = build(m_ids, 0);
+    m_built = m_values.size();
+}
+
+uint32_t KdTree::build(std::span<uint32_t> ids, const size_t depth)
+{
+    if (ids.empty()) {
+        return NoNode;
+    }
+
+    const auto axis = depth % m_dimentions;
+    const auto middle = ids.begin() + ids.size() / 2;
+
+    std::ranges::nth_element(ids, middle, [this, axis](const auto a, const auto b) {
+        return m_points[a * m_dimentions + axis] < m_points[b * m_dimentions + axis];
+    });
+
+    auto& node = m_nodes[*middle];
+    node.axis = static_cast<uint32_t>(axis);
+    node.left = build(ids.first(middle - ids.begin()), depth + 1);
+    node.right = build(ids.subspan(middle - ids.begin() + 1), depth + 1);
+
+    return *middle;
+}
+
+void Surrogate::reset(const size_t dimentions, const size_t neighbours, const size_t archive)
+{
+    m_neighbours = std::max<size_t>(neighbours, 1);
+    m_archive.reset(dimentions, std::max(archive, 8 * m_neighbours));
+}
+
+void Surrogate::learn(std::span<const double> genes, const double fitness)
+{
+    m_archive.insert(genes, fitness);
+}
+
+double Surrogate::predict(std::span<const double> genes)
+{
+    m_archive.nearest(genes, m_neighbours, m_nearest);
+
+    double weights = 0.0;
+    double total = 0.0;
+
+    for (const auto& [distance, fitness] : m_nearest) {
+        //! A genome seen before is answered exactly.
+        if (distance == 0.0) {
+            return fitness;
+        }
+
+        weights += 1.0 / distance;
+        total += fitness / distance;
+    }
+
+    return weights > 0.0 ? total / weights : 0.0;
+}
+
+bool Surrogate::ready() const
+{
+    return m_archive.size() >= 2 * m_neighbours;
+}
+
+size_t Surrogate::size() const
+{
+    return m_archive.size();
+}
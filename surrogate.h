@@ -0,0 +1,86 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+//! Point archive for nearest neighbour queries. Points go in one at a time below the
+//! leaf they fall into; the tree is rebuilt balanced (median splits) each time it has
+//! doubled since the last rebuild, so inserts stay amortized O(log n). A full archive
+//! drops its older half and is rebuilt from the newer one, so it holds between
+//! capacity / 2 and capacity of the latest points and its memory does not grow with
+//! the number of inserts.
+class KdTree final
+{
+public:
+    explicit KdTree(const size_t dimentions = 0, const size_t capacity = DefaultCapacity);
+
+    static constexpr size_t DefaultCapacity = 4096;
+
+    //! Drops every point.
+    void reset(const size_t dimentions, const size_t capacity = DefaultCapacity);
+    void insert(std::span<const double> point, const double value);
+
+    //! The \a k nearest points to \a query as (squared distance, value), nearest first.
+    void nearest(std::span<const double> query, const size_t k, std::vector<std::pair<double, double>>& out);
+
+    size_t size() const;
+    size_t dimentions() const;
+
+private:
+    static constexpr uint32_t NoNode = UINT32_MAX;
+
+    struct Node
+    {
+        uint32_t left = NoNode;
+        uint32_t right = NoNode;
+        uint32_t axis = 0;
+    };
+
+    struct Visit
+    {
+        uint32_t node;
+        double bound;
+    };
+
+    std::span<const double> point(const uint32_t ix) const;
+    //! Keeps the newest \a count points only.
+    void dropOldest(const size_t count);
+    void rebuild();
+    uint32_t build(std::span<uint32_t> ids, const size_t depth);
+
+    size_t m_dimentions;
+    size_t m_capacity;
+    std::vector<double> m_points;
+    std::vector<double> m_values;
+    //! Node i holds point i.
+    std::vector<Node> m_nodes;
+    uint32_t m_root = NoNode;
+    size_t m_built = 0;
+    std::vector<uint32_t> m_ids;
+    std::vector<Visit> m_stack;
+};
+
+//! Fitness model learnt from evaluated genomes: inverse distance weighted k nearest
+//! neighbour regression over a KdTree of decoded genes. Learning is one insert. The
+//! model only remembers the latest \a archive genomes or so, see KdTree; it is kept
+//! at no less than eight times the neighbours.
+class Surrogate final
+{
+public:
+    void reset(const size_t dimentions, const size_t neighbours, const size_t archive = KdTree::DefaultCapacity);
+
+    void learn(std::span<const double> genes, const double fitness);
+    //! Only meaningful once ready().
+    double predict(std::span<const double> genes);
+    //! Enough genomes seen for predictions to mean something: twice the neighbours.
+    bool ready() const;
+
+    size_t size() const;
+
+private:
+    KdTree m_archive;
+    size_t m_neighbours = 8;
+    std::vector<std::pair<double, double>> m_nearest;
+};
@@ -0,0 +1,108 @@
+#include "telemetry.h"
+
+#include <array>
+#include <cmath>
+#include <charconv>
+#include <type_traits>
+
+Telemetry& Telemetry::none()
+{
+    static Telemetry telemetry;
+    return telemetry;
+}
+
+template<class Value>
+void StreamTelemetry::append(const char* name, const Value value, const bool last)
+{
+    if (m_format == Format::JsonLines) {
+        m_buffer += '"';
+        m_buffer += name;
+        m_buffer += "\":";
+    }
+
+    bool finite = true;
+
+    if constexpr (std::is_floating_point_v<Value>) {
+        finite = std::isfinite(value);
+    }
+
+    //! JSON has no inf or nan.
+    if (!finite && m_format == Format::JsonLines) {
+        m_buffer += "null";
+    } else {
+        std::array<char, 32> digits;
+        const auto end = std::to_chars(digits.data(), digits.data() + digits.size(), value).ptr;
+        m_buffer.append(digits.data(), end);
+    }
+
+    if (!last) {
+        m_buffer += ',';
+    }
+}
+
+StreamTelemetry::StreamTelemetry(std::ostream& out, const Format format, const size_t bufferBytes)
+    : m_out{out}
+    , m_format{format}
+    , m_bufferBytes{bufferBytes}
+{
+    m_buffer.reserve(bufferBytes + 512);
+
+    if (format == Format::Csv) {
+        m_buffer += "run,island,epoch,best,mean,stddev,diversity,evaluations,cache_hits,predictions,allocations,"
+                    "evaluate_ns,select_ns,crossover_ns,mutate_ns\n";
+    }
+}
+
+StreamTelemetry::~StreamTelemetry()
+{
+    flush();
+}
+
+bool StreamTelemetry::enabled() const
+{
+    return true;
+}
+
+void StreamTelemetry::epoch(const EpochStats& stats)
+{
+    std::lock_guard lock(m_mutex);
+
+    if (m_format == Format::JsonLines) {
+        m_buffer += '{';
+    }
+
+    append("run", stats.run);
+    append("island", uint64_t{stats.island});
+    append("epoch", stats.epoch);
+    append("best", stats.best);
+    append("mean", stats.mean);
+    append("stddev", stats.stddev);
+    append("diversity", stats.diversity);
+    append("evaluations", stats.evaluations);
+    append("cache_hits", stats.cacheHits);
+    append("predictions", stats.predictions);
+    append("allocations", stats.allocations);
+    append("evaluate_ns", stats.evaluateNs);
+    append("select_ns", stats.selectNs);
+    append("crossover_ns", stats.crossoverNs);
+    append("mutate_ns", stats.mutateNs, true);
+
+    m_buffer += m_format == Format::JsonLines ? "}\n" : "\n";
+
+    if (m_buffer.size() >= m_bufferBytes) {
+        flushLocked();
+    }
+}
+
+void StreamTelemetry::flush()
+{
+    std::lock_guard lock(m_mutex);
+    flushLocked();
+    m_out.flush();
+}
+
+void StreamTelemetry::flushLocked()
+{
+    m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <ostream>
+
+//! What GeneticAlgo records about one epoch of one run. Phase times are wall clock
+//! nanoseconds; evaluations, cacheHits and predictions (surrogate answers) count this
+//! epoch only.
+struct EpochStats
+{
+    uint64_t run = 0;
+    uint32_t island = 0;
+    uint64_t epoch = 0;
+    double best = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double diversity = 0.0;
+    uint64_t evaluations = 0;
+    uint64_t cacheHits = 0;
+    uint64_t predictions = 0;
+    uint64_t allocations = 0;
+    double evaluateNs = 0.0;
+    double selectNs = 0.0;
+    double crossoverNs = 0.0;
+    double mutateNs = 0.0;
+};
+
+//! Receiver of per-epoch statistics. The base class is the no-op default: while
+//! enabled() is false GeneticAlgo neither reads the clock nor computes any statistic,
+//! so telemetry costs one branch per epoch. Island runs report from several threads
+//! at once, implementations have to be thread safe.
+class Telemetry
+{
+public:
+    virtual ~Telemetry() = default;
+
+    virtual bool enabled() const { return false; }
+    virtual void epoch(const EpochStats&) {}
+    virtual void flush() {}
+
+    //! Shared no-op instance.
+    static Telemetry& none();
+};
+
+//! Writes one record per epoch as CSV (with a header line) or JSON lines. Records are
+//! formatted into a buffer that only goes to the stream once it is full, on flush()
+//! and on destruction.
+class StreamTelemetry final : public Telemetry
+{
+public:
+    enum class Format
+    {
+        Csv = 0,
+        JsonLines
+    };
+
+    StreamTelemetry(std::ostream& out, const Format format = Format::Csv, const size_t bufferBytes = 1 << 16);
+    ~StreamTelemetry() override;
+
+    StreamTelemetry(const StreamTelemetry&) = delete;
+    StreamTelemetry& operator=(const StreamTelemetry&) = delete;
+
+    bool enabled() const override;
+    void epoch(const EpochStats& stats) override;
+    void flush() override;
+
+private:
+    template<class Value>
+    void append(const char* name, const Value value, const bool last = false);
+    void flushLocked();
+
+    std::ostream& m_out;
+    Format m_format;
+    size_t m_bufferBytes;
+    std::string m_buffer;
+    std::mutex m_mutex;
+};
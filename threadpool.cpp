@@ -0,0 +1,138 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(const size_t threads)
+    : m_ranges{std::make_unique<Range[]>(std::max<size_t>(threads, 1))}
+{
+    const auto workers = std::max<size_t>(threads, 1) - 1;
+    m_threads.reserve(workers);
+
+    for (size_t i = 0; i < workers; ++i) {
+        m_threads.emplace_back([this, i]() {
+            workerLoop(i + 1);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::size() const
+{
+    return m_threads.size() + 1;
+}
+
+void ThreadPool::run(Task task, void* context, const size_t count, const size_t grain)
+{
+    if (count == 0) {
+        return;
+    }
+
+    std::lock_guard submitLock(m_submitMutex);
+
+    const auto participants = size();
+    const auto chunkSize = std::max<size_t>(grain, 1);
+    const auto chunks = (count + chunkSize - 1) / chunkSize;
+
+    for (size_t i = 0; i < participants; ++i) {
+        m_ranges[i].next.store(chunks * i / participants, std::memory_order_relaxed);
+        m_ranges[i].end = chunks * (i + 1) / participants;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_task = task;
+        m_context = context;
+        m_count = count;
+        m_grain = chunkSize;
+        m_error = nullptr;
+        m_busy = m_threads.size();
+        ++m_generation;
+    }
+
+    m_wake.notify_all();
+    process(0);
+
+    std::unique_lock lock(m_mutex);
+    m_done.wait(lock, [this]() {
+        return m_busy == 0;
+    });
+
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void ThreadPool::workerLoop(const size_t worker)
+{
+    uint64_t seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_wake.wait(lock, [this, seen]() {
+                return m_stop || m_generation != seen;
+            });
+
+            if (m_stop) {
+                return;
+            }
+
+            seen = m_generation;
+        }
+
+        process(worker);
+
+        {
+            std::lock_guard lock(m_mutex);
+
+            if (--m_busy == 0) {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::process(const size_t worker)
+{
+    const auto participants = size();
+
+    const auto drain = [&, this](Range& range) {
+        for (;;) {
+            const auto chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+
+            if (chunk >= range.end) {
+                return;
+            }
+
+            const auto begin = chunk * m_grain;
+            const auto end = std::min(begin + m_grain, m_count);
+
+            try {
+                m_task(m_context, begin, end, worker);
+            } catch (...) {
+                std::lock_guard lock(m_mutex);
+
+                if (!m_error) {
+                    m_error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    for (size_t i = 0; i < participants; ++i) {
+        drain(m_ranges[(worker + i) % participants]);
+    }
+}
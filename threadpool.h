@@ -0,0 +1,69 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+//! Persistent pool of worker threads. The calling thread takes part in every
+//! parallelFor, so a pool of size 1 spawns no threads and runs serially.
+class ThreadPool final
+{
+public:
+    explicit ThreadPool(const size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //! Number of participants, the calling thread included.
+    size_t size() const;
+
+    //! Splits [0, count) into chunks of \a grain items and calls f(begin, end, worker)
+    //! for each of them, worker being in [0, size()). Every participant starts on its
+    //! own contiguous share of chunks and steals from the others once it runs dry.
+    //! Blocks until all chunks are done and rethrows the first exception thrown by f.
+    template<class Func>
+    void parallelFor(const size_t count, const size_t grain, Func&& f)
+    {
+        const auto task = [](void* context, const size_t begin, const size_t end, const size_t worker) {
+            (*static_cast<std::remove_reference_t<Func>*>(context))(begin, end, worker);
+        };
+
+        run(task, &f, count, grain);
+    }
+
+private:
+    using Task = void (*)(void*, size_t, size_t, size_t);
+
+    struct alignas(64) Range
+    {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+
+    void run(Task task, void* context, const size_t count, const size_t grain);
+    void workerLoop(const size_t worker);
+    void process(const size_t worker);
+
+    std::vector<std::thread> m_threads;
+    std::unique_ptr<Range[]> m_ranges;
+
+    std::mutex m_submitMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_generation = 0;
+    size_t m_busy = 0;
+    bool m_stop = false;
+
+    Task m_task = nullptr;
+    void* m_context = nullptr;
+    size_t m_count = 0;
+    size_t m_grain = 1;
+    std::exception_ptr m_error;
+};
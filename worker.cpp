@@ -0,0 +1,38 @@
+#include <string>
+#include <iostream>
+
+#include "processfitness.h"
+#include "benchmarkfunctions.h"
+
+//! Example ProcessFitness worker serving one of the benchmark functions, e.g.
+//! ProcessFitness({.command = {"genetic_algo_worker", "rastrigin"}}). A simulator
+//! wrapper looks the same with its own fitness function.
+int main(int argc, char* argv[])
+{
+    const std::string function = argc > 1 ? argv[1] : "";
+
+    if (function == "sphere") {
+        return ProcessFitness::serve(Sphere{});
+    }
+
+    if (function == "rastrigin") {
+        return ProcessFitness::serve(Rastrigin{});
+    }
+
+    if (function == "rosenbrock") {
+        return ProcessFitness::serve(Rosenbrock{});
+    }
+
+    if (function == "ackley") {
+        return ProcessFitness::serve(Ackley{});
+    }
+
+    if (function == "michalewicz") {
+        return ProcessFitness::serve(Michalewicz{});
+    }
+
+    std::cerr << "usage: " << (argc > 0 ? argv[0] : "genetic_algo_worker")
+              << " sphere|rastrigin|rosenbrock|ackley|michalewicz" << std::endl;
+
+    return 2;
+}